@@ -1,28 +1,21 @@
 #pragma once
-#include <vector>
 #include "Object.h"
 #include "vecFunctions.h"
 
-class ControlledBoid;
-
-// Boid class representing an individual boid in the flock
+// Boid class holding the appearance of a boid and drawing it.
+// Flock members live in a FlockState; the flock draws them through a single Boid view.
 class Boid : public Object
 {
 public:
 	Boid();
-	Boid(const Vec3 pos, ControlledBoid* leader);
 
-	// Boid behavior methods
-	void update(const std::vector<Boid*>& boids, GLfloat deltaTime);
-	
-	// Draw the boid
+	// Draw the boid (yaw follows the velocity)
 	void draw() override;
+	// Draw the boid with the current position, yaw and wing angle
+	void drawPose();
 	void drawShadow();
 	void drawBody();
 
-	// Set leader boid
-	void setLeader(ControlledBoid* leader) { leaderBoid = leader; }
-	
 	// Getters for movement attributes
 	GLfloat getYaw() const { return yaw; }
 	GLfloat getMaxSpeed() const { return maxSpeed; }
@@ -50,14 +43,6 @@ private:
 	// Movement attributes
 	GLfloat yaw;				// Facing direction in degrees
 	GLfloat maxSpeed;			// Maximum speed
-	GLfloat maxForce;			// Maximum steering force
-	GLfloat neighRadius;		// Neighborhood radius
-	GLfloat separationRadius;	// Separation radius
-
-	// Weights for behaviors
-	GLfloat weightCohesion;	// Weight for cohesion behavior
-	GLfloat weightSeparation;	// Weight for separation behavior
-	GLfloat weightAlignment;	// Weight for alignment behavior
 
 	// Body colors
 	Vec3 frontColor, bodyColor, wingColor, wireColor = Color::Black;
@@ -73,15 +58,6 @@ private:
 	GLfloat tailLength, tailRadius;
 	GLfloat wingSpan, wingChord, wingThickness;
 
-	// Leader
-	ControlledBoid* leaderBoid = nullptr; // Pointer to the controlled boid leader
-
-	// Behavior methods
-	void applyBehaviors(const std::vector<Boid*>& neighbors, GLfloat dt);
-	void flock(const std::vector<Boid*>& neighbors, GLfloat& rx, GLfloat& ry, GLfloat& rz);
-	void separate(const std::vector<Boid*>& neighbors, GLfloat& rx, GLfloat& ry, GLfloat& rz);
-	void align(const std::vector<Boid*>& neighbors, GLfloat& rx, GLfloat& ry, GLfloat& rz);
-	
 	// Helper method to draw the boid geometry
 	void drawGeometry(bool useColor) const;
 };
@@ -0,0 +1,167 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "Collision.h"
+#include "World.h"
+#include "Obstacle.h"
+#include "ObstacleBVH.h"
+
+static const int maxCollisionSubsteps = 4;		// Hits resolved per move
+static const GLfloat contactOffset = 1e-3f;		// Distance kept from a face after a hit
+
+// Earliest hit of the segment with the inflated box (slab test)
+bool sweepBox(const Vec3& from, const Vec3& delta, const Vec3& boxMin, const Vec3& boxMax,
+	GLfloat padding, GLfloat& t, Vec3& normal)
+{
+	const GLfloat p[3] = { from.x, from.y, from.z };
+	const GLfloat d[3] = { delta.x, delta.y, delta.z };
+	const GLfloat lo[3] = { boxMin.x - padding, boxMin.y - padding, boxMin.z - padding };
+	const GLfloat hi[3] = { boxMax.x + padding, boxMax.y + padding, boxMax.z + padding };
+
+	GLfloat enter = -std::numeric_limits<GLfloat>::infinity();
+	GLfloat exit = std::numeric_limits<GLfloat>::infinity();
+	int axis = -1;
+	for (int a = 0; a < 3; ++a)
+	{
+		if (std::fabs(d[a]) < 1e-12f)
+		{
+			// Parallel to the slab: inside it or never
+			if (p[a] < lo[a] || p[a] > hi[a]) return false;
+			continue;
+		}
+		GLfloat inv = 1.0f / d[a];
+		GLfloat t0 = (lo[a] - p[a]) * inv;
+		GLfloat t1 = (hi[a] - p[a]) * inv;
+		if (t0 > t1) std::swap(t0, t1);
+		if (t0 > enter) { enter = t0; axis = a; }
+		exit = std::min(exit, t1);
+		if (enter > exit) return false;
+	}
+
+	// Starting inside (enter < 0) or reaching the box after the end of the segment
+	if (axis < 0 || enter < 0.0f || enter > 1.0f) return false;
+
+	t = enter;
+	normal = Zero;
+	GLfloat side = d[axis] > 0.0f ? -1.0f : 1.0f;
+	if (axis == 0) normal.x = side;
+	else if (axis == 1) normal.y = side;
+	else normal.z = side;
+	return true;
+}
+
+// Call visit(boxMin, boxMax) with the collidable obstacles that may overlap the XZ
+// bounds (through the hierarchy when it matches the obstacles)
+template <typename Visit>
+static void forEachObstacleBox(GLfloat minX, GLfloat minZ, GLfloat maxX, GLfloat maxZ, Visit&& visit)
+{
+	if (!gWorldObstacles) return;
+
+	if (gWorldObstacleBVH && gWorldObstacleBVH->getSourceCount() == gWorldObstacles->size())
+	{
+		// Boxes of the leaves the bounds overlap
+		const PackedBoxes& boxes = gWorldObstacleBVH->getPacked();
+		gWorldObstacleBVH->forEachLeaf(minX, minZ, maxX, maxZ,
+			[&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					if (boxes.topY[i] < boxes.bottomY[i]) continue;	// Padding slot
+					visit(Vec3(boxes.centerX[i] - boxes.halfX[i], boxes.bottomY[i], boxes.centerZ[i] - boxes.halfZ[i]),
+						Vec3(boxes.centerX[i] + boxes.halfX[i], boxes.topY[i], boxes.centerZ[i] + boxes.halfZ[i]));
+				}
+			});
+	}
+	else
+	{
+		for (auto& obs : *gWorldObstacles)
+		{
+			if (!obs.canCollide()) continue;
+			Vec3 pos = obs.getPosition();
+			Vec3 half = obs.getSize() * 0.5f;
+			visit(pos - half, pos + half);
+		}
+	}
+}
+
+// Earliest hit of the segment with the collidable obstacles
+bool sweepObstacles(const Vec3& from, const Vec3& delta, GLfloat padding, GLfloat& t, Vec3& normal)
+{
+	bool hit = false;
+	t = 1.0f;
+	const Vec3 to = from + delta;
+	forEachObstacleBox(std::min(from.x, to.x) - padding, std::min(from.z, to.z) - padding,
+		std::max(from.x, to.x) + padding, std::max(from.z, to.z) + padding,
+		[&](const Vec3& boxMin, const Vec3& boxMax)
+		{
+			GLfloat boxT;
+			Vec3 boxNormal;
+			if (sweepBox(from, delta, boxMin, boxMax, padding, boxT, boxNormal) && boxT <= t)
+			{
+				t = boxT;
+				normal = boxNormal;
+				hit = true;
+			}
+		});
+	return hit;
+}
+
+// Move a point out of the collidable obstacles it is inside of
+bool pushOutOfObstacles(Vec3& pos, GLfloat padding, Vec3& normal)
+{
+	bool pushed = false;
+	forEachObstacleBox(pos.x - padding, pos.z - padding, pos.x + padding, pos.z + padding,
+		[&](const Vec3& boxMin, const Vec3& boxMax)
+		{
+			const Vec3 lo = boxMin - Vec3(padding, padding, padding);
+			const Vec3 hi = boxMax + Vec3(padding, padding, padding);
+			if (pos.x <= lo.x || pos.x >= hi.x || pos.y <= lo.y || pos.y >= hi.y || pos.z <= lo.z || pos.z >= hi.z)
+				return;
+
+			// Shortest way out: through a side or the top (the floor is under the bottom)
+			GLfloat depth = hi.y - pos.y;
+			Vec3 out = UnitY;
+			if (pos.x - lo.x < depth) { depth = pos.x - lo.x; out = Vec3(-1.0f, 0.0f, 0.0f); }
+			if (hi.x - pos.x < depth) { depth = hi.x - pos.x; out = UnitX; }
+			if (pos.z - lo.z < depth) { depth = pos.z - lo.z; out = Vec3(0.0f, 0.0f, -1.0f); }
+			if (hi.z - pos.z < depth) { depth = hi.z - pos.z; out = UnitZ; }
+
+			pos += out * (depth + contactOffset);
+			normal = out;
+			pushed = true;
+		});
+	return pushed;
+}
+
+// Move along the velocity, stopping at the obstacles and sliding along them
+Vec3 moveWithCollisions(const Vec3& pos, Vec3& vel, GLfloat dt, GLfloat padding)
+{
+	Vec3 p = pos;
+	GLfloat remaining = dt;
+
+	// A point that starts inside a box (spawned there, or the box was placed on it)
+	// would pass through it: leave it first, without the velocity into that face
+	Vec3 outNormal;
+	if (pushOutOfObstacles(p, padding, outNormal))
+	{
+		GLfloat into = dotProduct(vel, outNormal);
+		if (into < 0.0f) vel -= outNormal * into;
+	}
+
+	for (int substep = 0; substep < maxCollisionSubsteps && remaining > 0.0f; ++substep)
+	{
+		const Vec3 move = vel * remaining;
+		GLfloat t;
+		Vec3 normal;
+		if (!sweepObstacles(p, move, padding, t, normal))
+			return p + move;
+
+		// Stop at the contact, just off the face, and drop the velocity into it
+		p += move * t + normal * contactOffset;
+		GLfloat into = dotProduct(vel, normal);
+		if (into < 0.0f) vel -= normal * into;
+		remaining *= 1.0f - t;
+	}
+	return p;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "vecFunctions.h"
+
+/* Swept collision of moving points against the world obstacles (gWorldObstacles) */
+
+// Earliest hit of the segment from + t * delta (t in [0, 1]) with the box [boxMin, boxMax]
+// inflated by 'padding'; 'normal' is the axis-aligned face normal at the hit.
+// Segments starting inside the box do not hit it, so a point can always leave.
+bool sweepBox(const Vec3& from, const Vec3& delta, const Vec3& boxMin, const Vec3& boxMax,
+	GLfloat padding, GLfloat& t, Vec3& normal);
+
+// Earliest hit of the segment from + t * delta with the collidable obstacles
+// (through the obstacle hierarchy when it matches them)
+bool sweepObstacles(const Vec3& from, const Vec3& delta, GLfloat padding, GLfloat& t, Vec3& normal);
+
+// Move a point inside collidable obstacles (inflated by 'padding') out of them, each
+// time through the nearest side or the top; 'normal' is the face it last left through.
+// False if the point was outside every obstacle.
+bool pushOutOfObstacles(Vec3& pos, GLfloat padding, Vec3& normal);
+
+// Move 'pos' along 'vel' for dt, stopping at the obstacles and sliding along them:
+// a point starting inside an obstacle is first pushed out of it, then each hit ends a
+// substep at the contact, removes the velocity into the face and goes on with the
+// time left, so only points whose motion crosses a box take extra substeps
+Vec3 moveWithCollisions(const Vec3& pos, Vec3& vel, GLfloat dt, GLfloat padding);
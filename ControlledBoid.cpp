@@ -44,6 +44,8 @@ void ControlledBoid::stop()
 
 void ControlledBoid::update(GLfloat deltaTime)
 {
+	previousPosition = getPosition();
+
 	// Update height towards target height
 	if (deltaTime > 0.0f)
 	{
@@ -73,3 +75,12 @@ void ControlledBoid::update(GLfloat deltaTime)
 	newPos.y = height;
 	setPosition(newPos);
 }
+
+// Draw at the position interpolated between the previous and the current update
+void ControlledBoid::draw(GLfloat alpha)
+{
+	const Vec3 simPos = getPosition();
+	setPosition(getInterpolatedPosition(alpha));
+	Boid::draw();
+	setPosition(simPos);
+}
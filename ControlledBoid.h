@@ -19,10 +19,21 @@ public:
 	// Override update to include control
 	void update(GLfloat deltaTime);
 
+	// Forget the previous position (after teleporting the boid)
+	void resetInterpolation() { previousPosition = getPosition(); }
+
+	// Position interpolated between the previous and the current update (alpha in [0, 1])
+	Vec3 getInterpolatedPosition(GLfloat alpha) const { return lerp(previousPosition, getPosition(), alpha); }
+
+	// Draw at the interpolated position
+	void draw(GLfloat alpha);
+	using Boid::draw;
+
 private:
 	GLfloat speed;				 // Movement speed
 	GLfloat acceleration;		 // Acceleration value
 	GLfloat height;				// Current height	
 	GLfloat targetHeight;		 // Target height
 	GLfloat heightSmoothFactor; // Smoothing factor for height changes
+	Vec3 previousPosition;		// Position before the last update
 };
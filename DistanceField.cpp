@@ -0,0 +1,176 @@
+#include <cmath>
+#include <algorithm>
+
+#include "DistanceField.h"
+#include "Obstacle.h"
+#include "ObstacleBVH.h"
+#include "Tower.h"
+
+// Area covered, sample spacing and clamp distance
+void DistanceField::setBounds(GLfloat minX, GLfloat minZ, GLfloat maxX, GLfloat maxZ, GLfloat size, GLfloat bandWidth)
+{
+	cellSize = std::max(size, 1e-2f);
+	invCellSize = 1.0f / cellSize;
+	band = std::max(bandWidth, cellSize);
+	originX = minX;
+	originZ = minZ;
+	nodesX = std::max(2, static_cast<int32_t>(std::ceil((maxX - minX) * invCellSize)) + 1);
+	nodesZ = std::max(2, static_cast<int32_t>(std::ceil((maxZ - minZ) * invCellSize)) + 1);
+	tilesX = (nodesX + tileCells - 1) / tileCells;
+	tilesZ = (nodesZ + tileCells - 1) / tileCells;
+
+	samples.assign(static_cast<size_t>(nodesX) * nodesZ, { band, 0.0f, 0.0f });
+	invalidateAll();
+}
+
+// Mark the tiles whose distances depend on the box dirty
+void DistanceField::invalidate(GLfloat minX, GLfloat minZ, GLfloat maxX, GLfloat maxZ)
+{
+	if (dirty.empty()) return;
+
+	// Nodes within the band of the box
+	auto tileOf = [this](GLfloat v, GLfloat origin, int32_t tiles)
+	{
+		int32_t node = static_cast<int32_t>(std::floor((v - origin) * invCellSize));
+		return std::clamp(node / tileCells, 0, tiles - 1);
+	};
+	int32_t tx0 = tileOf(minX - band, originX, tilesX);
+	int32_t tx1 = tileOf(maxX + band + cellSize, originX, tilesX);
+	int32_t tz0 = tileOf(minZ - band, originZ, tilesZ);
+	int32_t tz1 = tileOf(maxZ + band + cellSize, originZ, tilesZ);
+
+	for (int32_t tz = tz0; tz <= tz1; ++tz)
+		for (int32_t tx = tx0; tx <= tx1; ++tx)
+			dirty[tz * tilesX + tx] = 1;
+}
+
+void DistanceField::invalidateAll()
+{
+	dirty.assign(static_cast<size_t>(tilesX) * tilesZ, 1);
+}
+
+// Rebake the dirty tiles
+void DistanceField::update(const std::vector<Obstacle>& obstacles, const ObstacleBVH& bvh, const Tower* tower)
+{
+	for (int32_t tz = 0; tz < tilesZ; ++tz)
+	{
+		for (int32_t tx = 0; tx < tilesX; ++tx)
+		{
+			uint8_t& flag = dirty[tz * tilesX + tx];
+			if (!flag) continue;
+			bakeTile(tx, tz, obstacles, bvh, tower);
+			flag = 0;
+		}
+	}
+}
+
+// Signed distance from (x, z) to a box of half size (hx, hz) centered at the origin,
+// with the direction in which it grows
+static GLfloat boxDistance(GLfloat x, GLfloat z, GLfloat hx, GLfloat hz, GLfloat& gradX, GLfloat& gradZ)
+{
+	GLfloat qx = std::fabs(x) - hx;
+	GLfloat qz = std::fabs(z) - hz;
+	GLfloat sx = x < 0.0f ? -1.0f : 1.0f;
+	GLfloat sz = z < 0.0f ? -1.0f : 1.0f;
+
+	if (qx > 0.0f || qz > 0.0f)
+	{
+		// Outside: away from the closest point
+		GLfloat ox = std::max(qx, 0.0f);
+		GLfloat oz = std::max(qz, 0.0f);
+		GLfloat d = std::sqrt(ox * ox + oz * oz);
+		gradX = sx * ox / d;
+		gradZ = sz * oz / d;
+		return d;
+	}
+
+	// Inside: out through the nearest side
+	if (qx > qz) { gradX = sx; gradZ = 0.0f; return qx; }
+	gradX = 0.0f; gradZ = sz;
+	return qz;
+}
+
+// Bake the nodes of one tile
+void DistanceField::bakeTile(int32_t tx, int32_t tz, const std::vector<Obstacle>& obstacles, const ObstacleBVH& bvh, const Tower* tower)
+{
+	// Tower base, as a circle of the radius used by the exact avoidance
+	const bool hasTower = tower && tower->canCollide();
+	Vec3 towerPos = hasTower ? tower->getPosition() : Zero;
+	GLfloat towerRadius = 0.0f;
+	if (hasTower)
+	{
+		Vec3 towerSize = tower->getSize();
+		towerRadius = std::max(std::max(towerSize.x, towerSize.z) * 0.75f, 1.0f);
+	}
+
+	const int32_t x0 = tx * tileCells, x1 = std::min(x0 + tileCells, nodesX);
+	const int32_t z0 = tz * tileCells, z1 = std::min(z0 + tileCells, nodesZ);
+
+	// Obstacles within the band of the tile
+	nearby.clear();
+	bvh.query(originX + x0 * cellSize - band, originZ + z0 * cellSize - band,
+		originX + (x1 - 1) * cellSize + band, originZ + (z1 - 1) * cellSize + band, nearby);
+
+	for (int32_t j = z0; j < z1; ++j)
+	{
+		for (int32_t i = x0; i < x1; ++i)
+		{
+			const GLfloat x = originX + i * cellSize;
+			const GLfloat z = originZ + j * cellSize;
+			Sample s = { band, 0.0f, 0.0f };
+
+			for (uint32_t k : nearby)
+			{
+				const Obstacle& obs = obstacles[k];
+				Vec3 pos = obs.getPosition();
+				Vec3 size = obs.getSize();
+				GLfloat gx, gz;
+				GLfloat d = boxDistance(x - pos.x, z - pos.z, size.x * 0.5f, size.z * 0.5f, gx, gz);
+				if (d < s.distance) s = { d, gx, gz };
+			}
+
+			if (hasTower)
+			{
+				GLfloat dx = x - towerPos.x;
+				GLfloat dz = z - towerPos.z;
+				GLfloat r = std::sqrt(dx * dx + dz * dz);
+				GLfloat d = r - towerRadius;
+				if (d < s.distance)
+				{
+					s.distance = d;
+					s.gradX = r > 0.0f ? dx / r : 1.0f;
+					s.gradZ = r > 0.0f ? dz / r : 0.0f;
+				}
+			}
+
+			samples[static_cast<size_t>(j) * nodesX + i] = s;
+		}
+	}
+	++bakedTiles;
+}
+
+// Bilinear lookup of the distance and gradient at (x, z)
+bool DistanceField::sample(GLfloat x, GLfloat z, GLfloat& distance, GLfloat& gradX, GLfloat& gradZ) const
+{
+	if (samples.empty()) return false;
+
+	GLfloat fx = (x - originX) * invCellSize;
+	GLfloat fz = (z - originZ) * invCellSize;
+	if (fx < 0.0f || fz < 0.0f || fx > nodesX - 1 || fz > nodesZ - 1) return false;
+
+	int32_t i = std::min(static_cast<int32_t>(fx), nodesX - 2);
+	int32_t j = std::min(static_cast<int32_t>(fz), nodesZ - 2);
+	GLfloat u = fx - i;
+	GLfloat v = fz - j;
+
+	const Sample& a = samples[static_cast<size_t>(j) * nodesX + i];
+	const Sample& b = samples[static_cast<size_t>(j) * nodesX + i + 1];
+	const Sample& c = samples[static_cast<size_t>(j + 1) * nodesX + i];
+	const Sample& d = samples[static_cast<size_t>(j + 1) * nodesX + i + 1];
+
+	GLfloat wa = (1.0f - u) * (1.0f - v), wb = u * (1.0f - v), wc = (1.0f - u) * v, wd = u * v;
+	distance = wa * a.distance + wb * b.distance + wc * c.distance + wd * d.distance;
+	gradX = wa * a.gradX + wb * b.gradX + wc * c.gradX + wd * d.gradX;
+	gradZ = wa * a.gradZ + wb * b.gradZ + wc * c.gradZ + wd * d.gradZ;
+	return true;
+}
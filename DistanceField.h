@@ -0,0 +1,71 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <GL/glut.h>
+
+class Obstacle;
+class ObstacleBVH;
+class Tower;
+
+// Signed distance field over a rectangle of the XZ plane, baked from the obstacle
+// boxes and the tower base, with the gradient (direction away from the nearest
+// surface) stored next to the distance. Distances are clamped to a band around the
+// surfaces. The field is split into tiles so a change only rebakes the tiles it touches.
+class DistanceField
+{
+public:
+	DistanceField() = default;
+	~DistanceField() = default;
+
+	// Area covered, sample spacing and clamp distance; marks every tile dirty
+	void setBounds(GLfloat minX, GLfloat minZ, GLfloat maxX, GLfloat maxZ, GLfloat cellSize, GLfloat band);
+
+	// Mark the tiles whose distances depend on [minX, maxX] x [minZ, maxZ] dirty
+	void invalidate(GLfloat minX, GLfloat minZ, GLfloat maxX, GLfloat maxZ);
+	void invalidateAll();
+
+	// Rebake the dirty tiles (the BVH must match 'obstacles'; tower may be null)
+	void update(const std::vector<Obstacle>& obstacles, const ObstacleBVH& bvh, const Tower* tower);
+
+	// Bilinear lookup of the distance and gradient at (x, z); false outside the field
+	bool sample(GLfloat x, GLfloat z, GLfloat& distance, GLfloat& gradX, GLfloat& gradZ) const;
+
+	// Area covered
+	GLfloat getMinX() const { return originX; }
+	GLfloat getMinZ() const { return originZ; }
+	GLfloat getMaxX() const { return originX + (nodesX - 1) * cellSize; }
+	GLfloat getMaxZ() const { return originZ + (nodesZ - 1) * cellSize; }
+
+	GLfloat getBand() const { return band; }
+	bool empty() const { return samples.empty(); }
+
+	// Tiles baked so far
+	uint64_t getBakedTiles() const { return bakedTiles; }
+
+	// Bytes held by the field
+	size_t getMemoryUsage() const { return samples.capacity() * sizeof(Sample) + dirty.capacity(); }
+
+private:
+	// Distance and gradient at a grid node
+	struct Sample
+	{
+		GLfloat distance;
+		GLfloat gradX, gradZ;
+	};
+
+	static const int32_t tileCells = 16;	// Nodes per tile side
+
+	void bakeTile(int32_t tx, int32_t tz, const std::vector<Obstacle>& obstacles, const ObstacleBVH& bvh, const Tower* tower);
+
+	GLfloat originX = 0.0f, originZ = 0.0f;	// First node
+	GLfloat cellSize = 1.0f;				// Node spacing
+	GLfloat invCellSize = 1.0f;
+	GLfloat band = 1.0f;					// Clamp distance
+	int32_t nodesX = 0, nodesZ = 0;			// Nodes per axis
+	int32_t tilesX = 0, tilesZ = 0;			// Tiles per axis
+	uint64_t bakedTiles = 0;				// Tiles baked so far
+
+	std::vector<Sample> samples;	// Nodes, row by row (nodesX per row)
+	std::vector<uint8_t> dirty;		// Tiles to rebake
+	std::vector<uint32_t> nearby;	// Obstacles near a node (scratch)
+};
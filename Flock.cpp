@@ -1,46 +1,48 @@
 #include <random>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <chrono>
 #include "Flock.h"
+#include "Steering.h"
+#include "Collision.h"
+#include "Philox.h"
 #include "vecFunctions.h"
+#include "World.h"
+#include "DistanceField.h"
 
-Flock::~Flock()
+// Boids per parallel-for chunk
+static const size_t updateGrain = 256;
+
+// Collision radius of a boid (swept collisions)
+static const GLfloat boidRadius = 0.25f;
+
+Flock::Flock()
 {
-	for (auto b : boids)
-		delete b;
-	boids.clear();
+	setThreadCount(0);
+	renderBoid.setSize(0.5f, 0.1f, 0.5f);
+	renderBoid.setWingAmplitude(params.wingAmplitude);
+	renderBoid.setWingBaseRate(params.wingBaseRate);
 }
 
 // Initialize the flock with a number of boids around a leader
-void Flock::init(int n, ControlledBoid* leader, GLfloat spread)
+void Flock::init(int n, ControlledBoid* leader, GLfloat spread, unsigned int seed)
 {
-	// Clear existing boids
-	for (auto b : boids) delete b;
-	boids.clear();
-
-	// Validate leader and number of boids
-	if (!leader) return;
+	// Validate number of boids
 	if (n < minBoids) n = minBoids;
 	if (n > maxBoids) n = maxBoids;
 
 	leaderBoid = leader;
+	if (seed == 0) seed = std::random_device()();
 
-	// Random number generation for initial positions
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_real_distribution<GLfloat> dist(-spread, spread);
-	std::uniform_real_distribution<GLfloat> vdist(-1.0f, 1.0f);
-	Vec3 center = leader->getPosition();
-
-	for (int i = 0; i < n; i++)
-	{
-		// Initial position around the leader
-		Vec3 pos = center + Vec3(dist(gen), dist(gen) * 0.1f, dist(gen));
-		auto b = new Boid(pos, leader);
-		boids.push_back(b);
-
-		// Initial velocity
-		boids.back()->setVelocity(vdist(gen), 0.0f, vdist(gen));
-		boids.back()->setSize(0.5f, 0.1f, 0.5f);
-	}
+	// Boids around the leader; handles start as the indices
+	state.clear();
+	boidSlots.clear();
+	stepsUntilReorder = 0;
+	Vec3 center = leader ? leader->getPosition() : Zero;
+	spawn(n, { center, Vec3(spread, spread * 0.1f, spread) }, seed);
+	spawnSeed = static_cast<uint64_t>(seed) << 32;
 }
 
 // Add a new boid to the flock near the leader
@@ -48,58 +50,550 @@ void Flock::addBoid()
 {
 	// Validate leader and flock size
 	if (!leaderBoid) return;
-	if (boids.size() >= static_cast<size_t>(maxBoids)) return;
-	
+	if (state.size() >= static_cast<size_t>(maxBoids)) return;
+
 	// Add a new boid near the leader
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_real_distribution<GLfloat> dist(-10.0f, 10.0f);
-	std::uniform_real_distribution<GLfloat> vdist(-1.0f, 1.0f);
+	spawn(1, { leaderBoid->getPosition(), Vec3(10.0f, 1.0f, 10.0f) }, ++spawnSeed);
+}
 
-	Vec3 center = leaderBoid->getPosition();
-	Vec3 pos = center + Vec3(dist(gen), dist(gen) * 0.1f, dist(gen));
-	auto b = new Boid(pos, leaderBoid);
-	b->setVelocity(vdist(gen), 0.0f, vdist(gen));
-	b->setSize(0.5f, 0.1f, 0.5f);
-	boids.push_back(b);
+// Append up to 'count' boids in 'region' in one parallel pass
+int Flock::spawn(int count, const SpawnRegion& region, uint64_t seed)
+{
+	const size_t first = state.size();
+	count = std::min(count, maxBoids - static_cast<int>(first));
+	if (count <= 0) return 0;
+
+	state.resize(first + count);
+	for (int k = 0; k < count; ++k)
+		boidSlots.insert();
+
+	// Boid k of the spawn draws blocks k of streams 0 (position and wing phase)
+	// and 1 (velocity)
+	const Philox rng(seed);
+	const Vec3 lo = region.center - region.halfSize;
+	const Vec3 hi = region.center + region.halfSize;
+	pool->parallelFor(count, updateGrain, [&](size_t begin, size_t end, unsigned)
+	{
+		for (size_t k = begin; k < end; ++k)
+		{
+			const Philox::Block a = rng(k, 0);
+			const Philox::Block b = rng(k, 1);
+			const size_t i = first + k;
+			state.posX[i] = Philox::uniform(a[0], lo.x, hi.x);
+			state.posY[i] = Philox::uniform(a[1], lo.y, hi.y);
+			state.posZ[i] = Philox::uniform(a[2], lo.z, hi.z);
+			state.velX[i] = Philox::uniform(b[0], -region.speed, region.speed);
+			state.velY[i] = 0.0f;
+			state.velZ[i] = Philox::uniform(b[1], -region.speed, region.speed);
+			state.yaw[i] = 0.0f;
+			state.wingAngle[i] = Philox::uniform(a[3], 0.0f, 2.0f * PI);
+			state.idleTime[i] = 0.0f;
+		}
+	});
+
+	hasPrevious = false;
+	neighborList.invalidate();
+	return count;
 }
 
 // Remove a boid from the flock
 void Flock::removeBoid()
 {
 	// Validate flock size
-	if (boids.size() <= static_cast<size_t>(minBoids)) return;
-	
+	if (state.size() <= static_cast<size_t>(minBoids)) return;
+
 	// Remove the last boid
-	auto b = boids.back();
-	boids.pop_back();
-	delete b;
+	removeBoid(boidSlots.getHandle(state.size() - 1));
+}
+
+// Remove a given boid: the last boid in storage takes its index
+bool Flock::removeBoid(BoidHandle handle)
+{
+	uint32_t slot;
+	if (!boidSlots.erase(handle, slot)) return false;
+
+	// Same move in the previous step, so the other boids still interpolate
+	state.swapErase(slot);
+	if (hasPrevious) nextState.swapErase(slot);
+	neighborList.invalidate();
+	return true;
+}
+
+// Structure used for metric neighbor queries
+void Flock::setSpatialIndex(SpatialIndex index)
+{
+	spatialIndex = index;
+	neighborList.setSpatialIndex(index);
+	neighborList.invalidate();
+}
+
+// Number of threads used by update (0 = hardware concurrency)
+void Flock::setThreadCount(unsigned count)
+{
+	pool = std::make_unique<ThreadPool>(count);
+	candidates.assign(pool->getThreadCount(), {});
 }
 
 Vec3 Flock::getAvgPosition() const
 {
 	auto pos = Zero;
-	if (boids.empty()) return pos;
-	auto count = static_cast<GLfloat>(boids.size());
-	for (auto b : boids)
-	{
-		if (!b) continue;
-		pos += b->getPosition();
-	}
+	if (state.empty()) return pos;
+	auto count = static_cast<GLfloat>(state.size());
+	for (size_t i = 0; i < state.size(); ++i)
+		pos += state.getPosition(i);
 	if (count > 0.0f) pos /= count;
 	return pos;
 }
 
-// Update all boids in the flock
+// FNV-1a hash of the bit patterns of a float array
+static uint64_t hashFloats(uint64_t h, const std::vector<GLfloat>& values)
+{
+	for (GLfloat v : values)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &v, sizeof(bits));
+		for (int b = 0; b < 4; ++b)
+		{
+			h ^= (bits >> (8 * b)) & 0xffu;
+			h *= 1099511628211ull;
+		}
+	}
+	return h;
+}
+
+// Approximate bytes held by the flock's state, neighbor search and scratch buffers
+size_t Flock::getMemoryUsage() const
+{
+	size_t bytes = (state.capacity() + nextState.capacity()) * FlockState::bytesPerBoid;
+	bytes += grid.getMemoryUsage();
+	bytes += quadTree.getMemoryUsage();
+	bytes += summedArea.getMemoryUsage();
+	bytes += allBoids.capacity() * sizeof(uint32_t);
+	bytes += neighborList.getMemoryUsage();
+	bytes += leaderFlow.getMemoryUsage();
+	bytes += reorderState.capacity() * FlockState::bytesPerBoid;
+	bytes += boidSlots.getMemoryUsage() + order.capacity() * sizeof(uint32_t);
+	bytes += sortKeys.capacity() * sizeof(uint64_t);
+	for (auto& list : candidates)
+		bytes += list.capacity() * sizeof(uint32_t);
+	return bytes;
+}
+
+// Hash of the bit patterns of the whole state, for comparing runs
+uint64_t Flock::getStateHash() const
+{
+	uint64_t h = 14695981039346656037ull;
+	h = hashFloats(h, state.posX);
+	h = hashFloats(h, state.posY);
+	h = hashFloats(h, state.posZ);
+	h = hashFloats(h, state.velX);
+	h = hashFloats(h, state.velY);
+	h = hashFloats(h, state.velZ);
+	h = hashFloats(h, state.yaw);
+	h = hashFloats(h, state.wingAngle);
+	return h;
+}
+
+// Update all boids in the flock.
+// The result is bitwise identical for any thread count:
+//  - each boid only reads 'state' and only writes its own slot of 'nextState';
+//  - the neighbor lists, and the grid and quadtree candidates for the scalar
+//    kernel, are sorted by flock index (the scalar sums then match the brute-force
+//    path); otherwise the grid lists candidates in bucket order, the quadtree in
+//    node order and the k-d tree in (distance, index) order. The neighbor lists are
+//    rebuilt on a test that does not depend on the threads, and the summed-area
+//    tables are built by one thread;
+//  - each boid's neighbor sums are reduced by one thread in that order, and the
+//    SIMD lanes are combined in a fixed order.
 void Flock::update(GLfloat dt)
 {
-	for (auto b : boids)
-		b->update(boids, dt);
+	const size_t n = state.size();
+	if (n == 0) return;
+
+	// Keep spatial neighbors close in memory
+	if (reorderInterval > 0 && stepsUntilReorder <= 0)
+	{
+		reorder();
+		stepsUntilReorder = reorderInterval;
+	}
+	--stepsUntilReorder;
+
+	nextState.resize(n);
+
+	// One flow field toward the leader for the whole flock; cells the obstacles
+	// overlap are blocked (a cell center is within 0.71 cell of any point of the cell)
+	if (leaderFlowField && leaderBoid && gWorldDistanceField)
+	{
+		Vec3 target = leaderBoid->getPosition();
+		leaderFlow.update(*gWorldDistanceField, target.x, target.z, 0.75f * leaderFlow.getCellSize());
+	}
+	scheduleSteering();
+
+	if (neighborMode == NeighborMode::Topological)
+	{
+		// Each boid interacts with its k nearest neighbors: cohesion and alignment
+		// have no radius, separation keeps its metric radius
+		BoidParams topoParams = params;
+		topoParams.neighRadius = std::numeric_limits<GLfloat>::infinity();
+
+		kdTree.build(state.posX.data(), state.posZ.data(), n);
+		pool->parallelFor(n, updateGrain, [&](size_t begin, size_t end, unsigned worker)
+		{
+			std::vector<uint32_t>& list = candidates[worker];
+			for (size_t i = begin; i < end; ++i)
+			{
+				if (coastBoid(static_cast<uint32_t>(i), dt)) continue;
+				list.clear();
+				kdTree.nearest(state.posX[i], state.posZ[i], topologicalCount, static_cast<uint32_t>(i), list);
+				updateBoid(static_cast<uint32_t>(i), list.data(), list.size(), topoParams, dt);
+			}
+		});
+	}
+	else if (neighborMode == NeighborMode::SummedArea)
+	{
+		// Cells a fraction of the smaller radius, so the boxes follow the radii closely
+		GLfloat cellSize = 0.5f * std::min(params.neighRadius, params.separationRadius);
+		summedArea.build(state.posX.data(), state.posZ.data(), state.velX.data(), state.velZ.data(), n, cellSize);
+
+		pool->parallelFor(n, updateGrain, [&](size_t begin, size_t end, unsigned)
+		{
+			for (size_t i = begin; i < end; ++i)
+				if (!coastBoid(static_cast<uint32_t>(i), dt))
+					updateBoid(static_cast<uint32_t>(i), nullptr, 0, params, dt);
+		});
+	}
+	else if (autoIndex && !neighborList.isEnabled())
+	{
+		// Time the update with the index picked by the selector
+		SpatialIndex index = indexSelector.next(n);
+		if (index != spatialIndex) setSpatialIndex(index);
+
+		auto start = std::chrono::steady_clock::now();
+		GLfloat crowding = updateMetric(dt);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		// The selector watches the grid's crowding: when another index ran, sample it
+		// from a grid built outside the timed update
+		if (crowding < 0.0f)
+		{
+			GLfloat radius = longRange ? params.separationRadius : std::max(params.neighRadius, params.separationRadius);
+			grid.build(state.posX.data(), state.posZ.data(), n, radius);
+			crowding = grid.getCrowding();
+		}
+		indexSelector.record(index, seconds, n, crowding);
+	}
+	else
+	{
+		updateMetric(dt);
+	}
+
+	// The written state becomes the current one
+	std::swap(state, nextState);
+	hasPrevious = true;
 }
 
-// Draw all boids in the flock
-void Flock::draw()
+// Metric neighbors: every boid inside neighRadius / separationRadius
+GLfloat Flock::updateMetric(GLfloat dt)
 {
-	for (auto b : boids)
-		b->draw();
+	const size_t n = state.size();
+	GLfloat crowding = -1.0f;
+
+	// With long-range flocking the neighbor pass only computes separation
+	BoidParams neighborParams = params;
+	if (longRange)
+	{
+		neighborParams.neighRadius = 0.0f;
+		quadTree.build(state.posX.data(), state.posZ.data(), n);
+		quadTree.buildAggregates(state.velX.data(), state.velZ.data());
+	}
+
+	if (neighborList.isEnabled())
+	{
+		// Reuse the lists until some boid has moved more than half the skin
+		GLfloat radius = std::max(neighborParams.neighRadius, neighborParams.separationRadius);
+		if (neighborList.needsRebuild(state, radius))
+		{
+			neighborList.build(state, radius, *pool);
+			crowding = neighborList.getCrowding();
+		}
+
+		pool->parallelFor(n, updateGrain, [&](size_t begin, size_t end, unsigned)
+		{
+			for (size_t i = begin; i < end; ++i)
+				if (!coastBoid(static_cast<uint32_t>(i), dt))
+					updateBoid(static_cast<uint32_t>(i), neighborList.getNeighbors(i), neighborList.getCount(i), neighborParams, dt);
+		});
+	}
+	else if (spatialIndex == SpatialIndex::BruteForce)
+	{
+		// Every boid is a candidate
+		if (allBoids.size() != n)
+		{
+			allBoids.resize(n);
+			for (size_t i = 0; i < n; ++i)
+				allBoids[i] = static_cast<uint32_t>(i);
+		}
+
+		pool->parallelFor(n, updateGrain, [&](size_t begin, size_t end, unsigned)
+		{
+			for (size_t i = begin; i < end; ++i)
+				if (!coastBoid(static_cast<uint32_t>(i), dt))
+					updateBoid(static_cast<uint32_t>(i), allBoids.data(), n, neighborParams, dt);
+		});
+	}
+	else if (spatialIndex == SpatialIndex::QuadTree)
+	{
+		// Boids within the largest radius, however dense the flock
+		GLfloat radius = std::max(neighborParams.neighRadius, neighborParams.separationRadius);
+		if (!longRange) quadTree.build(state.posX.data(), state.posZ.data(), n);
+
+		pool->parallelFor(n, updateGrain, [&](size_t begin, size_t end, unsigned worker)
+		{
+			std::vector<uint32_t>& list = candidates[worker];
+			for (size_t i = begin; i < end; ++i)
+			{
+				if (coastBoid(static_cast<uint32_t>(i), dt)) continue;
+				list.clear();
+				quadTree.query(state.posX[i], state.posZ[i], radius, list);
+
+				// Flock order for the scalar kernel, as on the grid path
+				if (!useSimd) std::sort(list.begin(), list.end());
+				updateBoid(static_cast<uint32_t>(i), list.data(), list.size(), neighborParams, dt);
+			}
+		});
+	}
+	else
+	{
+		// Every boid reads the previous step, so the 3x3 query over cells of the
+		// largest radius covers all neighbors
+		GLfloat cellSize = std::max(neighborParams.neighRadius, neighborParams.separationRadius);
+		grid.build(state.posX.data(), state.posZ.data(), n, cellSize);
+		crowding = grid.getCrowding();
+
+		pool->parallelFor(n, updateGrain, [&](size_t begin, size_t end, unsigned worker)
+		{
+			std::vector<uint32_t>& list = candidates[worker];
+			for (size_t i = begin; i < end; ++i)
+			{
+				if (coastBoid(static_cast<uint32_t>(i), dt)) continue;
+				// Candidates from the boid's cell and its adjacent cells
+				list.clear();
+				grid.query(state.posX[i], state.posZ[i], list);
+
+				// Keep flock order so the scalar steering sums match the brute-force path
+				// (the SIMD sums depend on which candidates share a block anyway)
+				if (!useSimd) std::sort(list.begin(), list.end());
+				updateBoid(static_cast<uint32_t>(i), list.data(), list.size(), neighborParams, dt);
+			}
+		});
+	}
+
+	return crowding;
+}
+
+// Spread the low 16 bits of v over the even bits
+static uint32_t spreadBits(uint32_t v)
+{
+	v &= 0xffffu;
+	v = (v | (v << 8)) & 0x00ff00ffu;
+	v = (v | (v << 4)) & 0x0f0f0f0fu;
+	v = (v | (v << 2)) & 0x33333333u;
+	v = (v | (v << 1)) & 0x55555555u;
+	return v;
+}
+
+// Sort the boids (both buffers and the handles) by Morton key of the XZ position
+void Flock::reorder()
+{
+	const size_t n = state.size();
+	if (n < 2) return;
+
+	// Quantize the positions to 16 bits over the flock's bounds
+	auto [minX, maxX] = std::minmax_element(state.posX.begin(), state.posX.end());
+	auto [minZ, maxZ] = std::minmax_element(state.posZ.begin(), state.posZ.end());
+	const GLfloat originX = *minX, originZ = *minZ;
+	const GLfloat extent = std::max(*maxX - originX, *maxZ - originZ);
+	const GLfloat scale = extent > 0.0f ? 65535.0f / extent : 0.0f;
+
+	// Key in the high half, slot in the low half: ties keep their order
+	sortKeys.resize(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		uint32_t qx = static_cast<uint32_t>((state.posX[i] - originX) * scale);
+		uint32_t qz = static_cast<uint32_t>((state.posZ[i] - originZ) * scale);
+		uint64_t key = spreadBits(qx) | (spreadBits(qz) << 1);
+		sortKeys[i] = (key << 32) | i;
+	}
+	std::sort(sortKeys.begin(), sortKeys.end());
+
+	order.resize(n);
+	for (size_t i = 0; i < n; ++i)
+		order[i] = static_cast<uint32_t>(sortKeys[i]);
+
+	// Permute both buffers so interpolation still pairs each boid with itself
+	reorderState.gather(state, order);
+	std::swap(state, reorderState);
+	if (hasPrevious)
+	{
+		reorderState.gather(nextState, order);
+		std::swap(nextState, reorderState);
+	}
+
+	// Follow the boids with their handles
+	boidSlots.permute(order);
+	neighborList.invalidate();
+}
+
+// Steer and integrate boid i from 'state' into 'nextState'
+void Flock::updateBoid(uint32_t i, const uint32_t* neighbors, size_t count, const BoidParams& neighborParams, GLfloat dt)
+{
+	const Vec3 pos = state.getPosition(i);
+	Vec3 vel = state.getVelocity(i);
+
+	Vec3 cohesion, separation, alignment;
+	if (neighborMode == NeighborMode::SummedArea)
+		steerSummedArea(summedArea, pos, vel, params, cohesion, separation, alignment);
+	else
+		steerNeighbors(state, i, neighbors, count, neighborParams, cohesion, separation, alignment, useSimd);
+
+	// Long-range cohesion and alignment from the Barnes-Hut tree
+	if (longRange && neighborMode == NeighborMode::Metric)
+	{
+		QuadTree::Aggregate sums;
+		quadTree.gather(pos.x, pos.z, params.longRangeRadius, params.openingAngle, sums);
+		steerAverages(pos, vel, sums.sumX, sums.sumZ, sums.sumVelX, sums.sumVelZ, static_cast<int>(sums.count), params, cohesion, alignment);
+	}
+
+	// Force zero y for planar behaviour and apply weights
+	cohesion.y = separation.y = alignment.y = 0.0f;
+	cohesion *= params.weightCohesion;
+	separation *= params.weightSeparation;
+	alignment *= params.weightAlignment;
+
+	// Obstacle and tower avoidance, leader following
+	Vec3 obstacleAvoid, towerAvoid;
+	if (!fieldAvoidance || !steerField(pos, params, obstacleAvoid))
+	{
+		obstacleAvoid = steerObstacles(pos, params);
+		towerAvoid = steerTower(pos, params);
+	}
+	const FlowField* flow = leaderFlowField && gWorldDistanceField ? &leaderFlow : nullptr;
+	Vec3 leaderAttract = steerLeader(pos, vel, leaderBoid, params, flow);
+
+	// Sum forces and limit
+	Vec3 steer = cohesion + separation + alignment + obstacleAvoid + towerAvoid + leaderAttract;
+	limit(steer, params.maxForce);
+
+	// Update velocity, over the steps the boid coasted too (level of detail)
+	vel = vel + steer * (state.idleTime[i] + dt);
+	limit(vel, params.maxSpeed);
+	nextState.idleTime[i] = 0.0f;
+	integrateBoid(i, pos, vel, dt);
+}
+
+// Level of detail: which boids the current update steers
+void Flock::scheduleSteering()
+{
+	if (!levelOfDetail) return;
+
+	const size_t n = state.size();
+	steerDue.resize(n);
+	const uint64_t step = lodStep++;
+
+	// Focus points: the leader and the camera (the leader twice without a camera)
+	const Vec3 leaderPos = leaderBoid ? leaderBoid->getPosition() : (hasCamera ? cameraPosition : Zero);
+	const Vec3 cameraPos = hasCamera ? cameraPosition : leaderPos;
+	const GLfloat near2 = lodDistance * lodDistance;
+
+	pool->parallelFor(n, updateGrain, [&](size_t begin, size_t end, unsigned)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			const Vec3 pos = state.getPosition(i);
+			GLfloat d2 = std::min(length2(pos - leaderPos), length2(pos - cameraPos));
+
+			// Interval doubles with each doubling of the distance past lodDistance
+			unsigned interval = 1;
+			for (GLfloat limit2 = near2; d2 >= limit2 && interval < lodMaxInterval; limit2 *= 4.0f)
+				interval *= 2;
+
+			// Staggered by handle entry, so a boid keeps its slice when the storage changes
+			steerDue[i] = ((step + boidSlots.getEntry(i)) & (interval - 1)) == 0;
+		}
+	});
+}
+
+// Move boid i along its velocity if the current update does not steer it
+bool Flock::coastBoid(uint32_t i, GLfloat dt)
+{
+	if (!levelOfDetail || steerDue[i]) return false;
+
+	nextState.idleTime[i] = state.idleTime[i] + dt;
+	integrateBoid(i, state.getPosition(i), state.getVelocity(i), dt);
+	return true;
+}
+
+// Write the velocity, heading, wings and position of boid i into 'nextState'
+void Flock::integrateBoid(uint32_t i, const Vec3& pos, Vec3 vel, GLfloat dt)
+{
+	// Update position based on velocity; with swept collisions the boid stops at the
+	// obstacles in its way and its velocity loses the part into them
+	Vec3 newPos = sweptCollisions ? moveWithCollisions(pos, vel, dt, boidRadius) : pos + vel * dt;
+
+	// Prevent falling below ground level
+	if (newPos.y < 0.1f) newPos.y = 0.1f;
+
+	nextState.setPosition(i, newPos);
+	nextState.setVelocity(i, vel);
+
+	// Wing animation update
+	GLfloat speed = length(vel);
+	GLfloat speedFactor = 0.0f;
+	if (params.maxSpeed > 1e-6) speedFactor = std::min(1.0f, speed / params.maxSpeed);
+
+	// Flap rate increases with speed (min 0.5x to max 2.0x)
+	GLfloat flapRate = params.wingBaseRate * (0.5f + 1.5f * speedFactor);
+	nextState.wingAngle[i] = state.wingAngle[i] + flapRate * dt;
+
+	// Facing direction follows the velocity
+	nextState.yaw[i] = state.yaw[i];
+	if (speed > 1e-6f) nextState.yaw[i] = std::atan2(vel.x, vel.z) * (180.0f / PI);
+}
+
+// Interpolate between two angles in degrees along the shortest arc
+static GLfloat lerpAngle(GLfloat a, GLfloat b, GLfloat alpha)
+{
+	GLfloat delta = std::fmod(b - a, 360.0f);
+	if (delta > 180.0f) delta -= 360.0f;
+	if (delta < -180.0f) delta += 360.0f;
+	return a + delta * alpha;
+}
+
+// Draw all boids in the flock, interpolated between the previous and the current step
+void Flock::draw(GLfloat alpha)
+{
+	draw(getPreviousState(), state, alpha);
+}
+
+// Draw a flock state, interpolated from 'previous' when both have the same boids
+void Flock::draw(const FlockState& previous, const FlockState& current, GLfloat alpha)
+{
+	const bool interpolate = previous.size() == current.size() && alpha < 1.0f;
+
+	for (size_t i = 0; i < current.size(); ++i)
+	{
+		if (interpolate)
+		{
+			renderBoid.setPosition(lerp(previous.getPosition(i), current.getPosition(i), alpha));
+			renderBoid.setYaw(lerpAngle(previous.yaw[i], current.yaw[i], alpha));
+			renderBoid.setWingAngle(previous.wingAngle[i] + (current.wingAngle[i] - previous.wingAngle[i]) * alpha);
+		}
+		else
+		{
+			renderBoid.setPosition(current.getPosition(i));
+			renderBoid.setYaw(current.yaw[i]);
+			renderBoid.setWingAngle(current.wingAngle[i]);
+		}
+		renderBoid.drawPose();
+	}
 }
@@ -1,33 +1,240 @@
 #pragma once
 #include <vector>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <bit>
 #include "Boid.h"
 #include "ControlledBoid.h"
+#include "FlockState.h"
+#include "SpatialGrid.h"
+#include "KDTree.h"
+#include "SummedAreaTable.h"
+#include "NeighborList.h"
+#include "ThreadPool.h"
+#include "IndexSelector.h"
+#include "FlowField.h"
+#include "SlotMap.h"
+
+// How a boid picks the neighbors it interacts with
+enum class NeighborMode
+{
+	Metric,			// Every boid inside neighRadius / separationRadius
+	Topological,	// The k nearest boids, whatever their distance
+	SummedArea		// Approximate: mean of the grid cells around the boid (dense swarms)
+};
+
+// Box that boids are spawned in: positions uniform in center +- halfSize, horizontal
+// velocity components uniform in [-speed, speed]
+struct SpawnRegion
+{
+	Vec3 center;
+	Vec3 halfSize;
+	GLfloat speed = 1.0f;
+};
+
+// Stable handle to a boid of a flock: unlike its index, it survives storage reordering
+// and removals, and stops resolving once its boid is removed
+using BoidHandle = SlotHandle;
+const BoidHandle invalidBoid = invalidSlot;
 
 // Flock class managing a collection of boids
 class Flock
 {
 public:
-	Flock() = default;
-	~Flock();
+	Flock();
+	~Flock() = default;
 
 	// Initialize the flock with a number of boids around a leader
-	void init(int n, ControlledBoid* leader, GLfloat spread);
-	
-	// Update and draw the flock
+	// (around the origin without a leader; seed 0 picks a random seed)
+	void init(int n, ControlledBoid* leader, GLfloat spread, unsigned int seed = 0);
+
+	// Update and draw the flock.
+	// draw interpolates between the previous and the current step (alpha in [0, 1]).
 	void update(GLfloat dt);
-	void draw();
-	
-	// Manage boids in the flock
+	void draw(GLfloat alpha = 1.0f);
+
+	// Draw a flock state, interpolated from 'previous' when both have the same boids
+	void draw(const FlockState& previous, const FlockState& current, GLfloat alpha);
+
+	// Manage boids in the flock (removeBoid() removes the last boid in storage)
 	void addBoid();
 	void removeBoid();
 
-	const std::vector<Boid*> getBoids() const { return boids; }
-	int getBoidCount() const { return static_cast<int>(boids.size()); }
+	// Remove a given boid in O(1): the last boid in storage takes its index.
+	// False if the boid was already removed.
+	bool removeBoid(BoidHandle handle);
+
+	// Append up to 'count' boids (within maxBoids) in 'region' in one parallel pass;
+	// returns the number added. The boids come from a counter-based generator, so the
+	// same seed gives the same boids whatever the thread count.
+	int spawn(int count, const SpawnRegion& region, uint64_t seed);
+
+	// Handle of the boid stored at 'index', and the current index of a handle
+	// (-1 once the boid was removed). Indices change when the storage is reordered
+	// and when boids are removed.
+	BoidHandle getHandle(size_t index) const { return boidSlots.getHandle(index); }
+	int findBoid(BoidHandle handle) const { return boidSlots.find(handle); }
+
+	// Sort the storage by Morton (Z-order) key of the XZ position every 'steps' updates
+	// so that spatial neighbors sit close in memory (0 disables)
+	void setReorderInterval(int steps) { reorderInterval = std::max(0, steps); }
+	int getReorderInterval() const { return reorderInterval; }
+
+	// Neighbor selection. In topological mode cohesion and alignment use the k nearest
+	// boids; separation still only reacts to those inside separationRadius. Summed-area
+	// mode trades accuracy for a per-boid cost that does not grow with the density.
+	void setNeighborMode(NeighborMode mode) { neighborMode = mode; }
+	NeighborMode getNeighborMode() const { return neighborMode; }
+	void setTopologicalCount(int k) { topologicalCount = std::max(1, k); }
+
+	// Structure used for metric neighbor queries
+	void setSpatialIndex(SpatialIndex index);
+	SpatialIndex getSpatialIndex() const { return spatialIndex; }
+
+	// Pick the spatial index at runtime from measured update costs (see IndexSelector).
+	// The choice depends on timings, so runs are no longer bitwise reproducible.
+	// Inactive while the Verlet lists are on: updates then mostly reuse the lists, so
+	// their cost is not the index's, and every switch would force a rebuild.
+	void setAutoSpatialIndex(bool enabled) { autoIndex = enabled; indexSelector.reset(); }
+	bool getAutoSpatialIndex() const { return autoIndex; }
+
+	// Long-range cohesion and alignment over params.longRangeRadius with the Barnes-Hut
+	// approximation (metric mode; separation stays exact)
+	void setLongRangeFlocking(bool enabled) { longRange = enabled; }
+	bool getLongRangeFlocking() const { return longRange; }
+	BoidParams& getParams() { return params; }
+
+	// Avoid obstacles and the tower through the baked distance field (one lookup per
+	// boid) instead of testing every nearby box; exact tests outside the field
+	void setFieldAvoidance(bool enabled) { fieldAvoidance = enabled; }
+	bool getFieldAvoidance() const { return fieldAvoidance; }
+
+	// Follow the leader along a flow field solved once per step around the obstacles
+	// (needs the world distance field) instead of heading straight at it
+	void setLeaderFlowField(bool enabled) { leaderFlowField = enabled; }
+	bool getLeaderFlowField() const { return leaderFlowField; }
+	const FlowField& getLeaderFlow() const { return leaderFlow; }
+
+	// Stop boids at the obstacles they would move through in one update (swept test,
+	// extra substeps only for the boids that hit something), whatever the step length.
+	// Off by default, since every boid move then queries the obstacles.
+	void setSweptCollisions(bool enabled) { sweptCollisions = enabled; }
+	bool getSweptCollisions() const { return sweptCollisions; }
+
+	// Level of detail: boids farther than 'distance' from the leader and the camera are
+	// steered every 2, 4, ... up to 'maxInterval' updates (doubling with each doubling of
+	// the distance), staggered by handle so each update steers an even share of them.
+	// In between they coast along their velocity, and the next steering update applies
+	// its force over the whole time since the last one.
+	void setLevelOfDetail(bool enabled) { levelOfDetail = enabled; }
+	bool getLevelOfDetail() const { return levelOfDetail; }
+	void setLodDistance(GLfloat distance) { lodDistance = std::max(distance, 1.0f); }
+	void setLodMaxInterval(int steps) { lodMaxInterval = std::bit_floor(static_cast<unsigned>(std::max(1, steps))); }
+
+	// Camera position used as a level of detail focus, with the leader
+	void setCameraPosition(const Vec3& position) { cameraPosition = position; hasCamera = true; }
+
+	// Verlet skin of the metric neighbor lists (0, the default, queries the spatial index every update)
+	void setNeighborSkin(GLfloat skin) { neighborList.setSkin(std::max(0.0f, skin)); }
+	GLfloat getNeighborSkin() const { return neighborList.getSkin(); }
+	uint64_t getNeighborListBuilds() const { return neighborList.getBuildCount(); }
+
+	// Use the SIMD neighbor kernel (scalar path when disabled)
+	void setSimdSteering(bool enabled) { useSimd = enabled; }
+
+	// Flock size limits used by init, addBoid and removeBoid
+	void setMaxBoids(int count) { maxBoids = count; }
+	int getMaxBoids() const { return maxBoids; }
+
+	// Approximate bytes held by the flock's state, neighbor search and scratch buffers
+	size_t getMemoryUsage() const;
+
+	// Number of threads used by update (0 = hardware concurrency)
+	void setThreadCount(unsigned count);
+	unsigned getThreadCount() const { return pool->getThreadCount(); }
+
+	const FlockState& getState() const { return state; }
+	// State before the last update (the current state if there is none)
+	const FlockState& getPreviousState() const { return hasPrevious ? nextState : state; }
+	const BoidParams& getParams() const { return params; }
+	int getBoidCount() const { return static_cast<int>(state.size()); }
 	Vec3 getAvgPosition() const;
 
+	// Hash of the bit patterns of the whole state, for comparing runs.
+	// update is bitwise deterministic, so the hash does not depend on the thread count.
+	uint64_t getStateHash() const;
+
 private:
-	std::vector<Boid*> boids; // Collection of boid pointers
+	// Double-buffered state: update reads 'state' (previous step) and writes 'nextState',
+	// then swaps them, so between updates 'nextState' holds the previous step
+	FlockState state;		// Simulation state of every boid
+	FlockState nextState;	// State being written by update
+	bool hasPrevious = false;	// 'nextState' holds the step before 'state'
+	BoidParams params;		// Steering parameters shared by the boids
+	Boid renderBoid;		// View used to draw each boid of the state
+
 	ControlledBoid* leaderBoid = nullptr; // Pointer to the controlled boid leader
 	int maxBoids = 200;    // Maximum number of boids in the flock
 	int minBoids = 10;     // Minimum number of boids in the flock
+	uint64_t spawnSeed = 1;	// Seed of the last addBoid (one per boid)
+	bool useSimd = true;   // Use the SIMD neighbor kernel
+	NeighborMode neighborMode = NeighborMode::Metric;	// Neighbor selection
+	int topologicalCount = 7;	// Neighbors per boid in topological mode
+	SpatialIndex spatialIndex = SpatialIndex::Grid;	// Structure for metric queries
+	bool longRange = false;		// Barnes-Hut cohesion and alignment
+	bool autoIndex = false;		// Spatial index picked by 'indexSelector'
+	bool fieldAvoidance = false;	// Obstacle avoidance from the distance field
+	bool leaderFlowField = false;	// Leader following along 'leaderFlow'
+	bool sweptCollisions = false;	// Boids stop at the obstacles
+	FlowField leaderFlow;			// Paths to the leader around the obstacles
+
+	// Level of detail
+	bool levelOfDetail = false;		// Steer far boids less often
+	GLfloat lodDistance = 150.0f;	// Distance steered every update
+	unsigned lodMaxInterval = 8;	// Longest interval between steering updates (power of 2)
+	Vec3 cameraPosition;			// Focus besides the leader
+	bool hasCamera = false;			// 'cameraPosition' was set
+	uint64_t lodStep = 0;			// Updates so far, for the staggering
+	std::vector<uint8_t> steerDue;	// Boids steered by the current update
+	IndexSelector indexSelector;	// Runtime choice of the spatial index
+
+	// Storage order
+	int reorderInterval = 16;				// Updates between Morton reorders
+	int stepsUntilReorder = 0;				// Updates left before the next reorder
+	SlotMap boidSlots;						// Handles of the boids, by storage index
+	std::vector<uint64_t> sortKeys;			// Morton key and slot of each boid
+	std::vector<uint32_t> order;			// New order of the slots
+	FlockState reorderState;				// Scratch state for reordering
+
+	// Parallel update
+	std::unique_ptr<ThreadPool> pool;					// Worker threads
+	std::vector<std::vector<uint32_t>> candidates;		// Candidate indices, one list per worker
+
+	// Neighbor search
+	SpatialGrid grid;						// Spatial grid rebuilt every update (metric mode)
+	QuadTree quadTree;						// Quadtree rebuilt every update (metric mode, Barnes-Hut)
+	std::vector<uint32_t> allBoids;			// 0 .. n - 1 (brute force)
+	KDTree kdTree;							// k-d tree rebuilt every update (topological mode)
+	SummedAreaTable summedArea;				// Tables rebuilt every update (summed-area mode)
+	NeighborList neighborList;				// Verlet lists reused across updates (metric mode)
+
+	// Metric-mode update of every boid into 'nextState'; returns the crowding of the
+	// grid when one was built (see IndexSelector::record), else -1
+	GLfloat updateMetric(GLfloat dt);
+
+	// Sort the boids (both buffers and the handles) by Morton key
+	void reorder();
+
+	// Level of detail: which boids the current update steers
+	void scheduleSteering();
+
+	// Move boid i along its velocity if the current update does not steer it
+	bool coastBoid(uint32_t i, GLfloat dt);
+
+	// Steer and integrate boid i from 'state' into 'nextState'
+	void updateBoid(uint32_t i, const uint32_t* neighbors, size_t count, const BoidParams& neighborParams, GLfloat dt);
+
+	// Write the velocity, heading, wings and position of boid i into 'nextState'
+	void integrateBoid(uint32_t i, const Vec3& pos, Vec3 vel, GLfloat dt);
 };
@@ -0,0 +1,114 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <GL/glut.h>
+
+#include "vecFunctions.h"
+
+// Steering parameters shared by every boid of a flock
+struct BoidParams
+{
+	GLfloat maxSpeed = 50.0f;			// Maximum speed
+	GLfloat maxForce = 40.0f;			// Maximum steering force
+	GLfloat neighRadius = 5.0f;			// Neighborhood radius
+	GLfloat separationRadius = 8.0f;	// Separation radius
+
+	// Long-range flocking (Barnes-Hut)
+	GLfloat longRangeRadius = 60.0f;	// Cohesion and alignment radius
+	GLfloat openingAngle = 0.5f;		// Largest node side / distance treated as one boid
+
+	// Weights for behaviors
+	GLfloat weightCohesion = 1.0f;		// Weight for cohesion behavior
+	GLfloat weightSeparation = 2.0f;	// Weight for separation behavior
+	GLfloat weightAlignment = 1.0f;		// Weight for alignment behavior
+
+	// Wing animation
+	GLfloat wingAmplitude = 30.0f;		// Wing flapping amplitude
+	GLfloat wingBaseRate = 8.0f;		// Wing flapping base rate
+};
+
+// Structure-of-arrays storage for the simulation state of a flock
+struct FlockState
+{
+	std::vector<GLfloat> posX, posY, posZ;	// Positions
+	std::vector<GLfloat> velX, velY, velZ;	// Velocities
+	std::vector<GLfloat> yaw;				// Facing direction in degrees
+	std::vector<GLfloat> wingAngle;			// Current wing angle
+	std::vector<GLfloat> idleTime;			// Time since the last steering update (level of detail)
+
+	// Bytes of state stored per boid
+	static constexpr size_t bytesPerBoid = 9 * sizeof(GLfloat);
+
+	size_t size() const { return posX.size(); }
+	size_t capacity() const { return posX.capacity(); }
+	bool empty() const { return posX.empty(); }
+
+	void clear() { resize(0); }
+
+	void resize(size_t n)
+	{
+		posX.resize(n); posY.resize(n); posZ.resize(n);
+		velX.resize(n); velY.resize(n); velZ.resize(n);
+		yaw.resize(n);
+		wingAngle.resize(n);
+		idleTime.resize(n);
+	}
+
+	void reserve(size_t n)
+	{
+		posX.reserve(n); posY.reserve(n); posZ.reserve(n);
+		velX.reserve(n); velY.reserve(n); velZ.reserve(n);
+		yaw.reserve(n);
+		wingAngle.reserve(n);
+		idleTime.reserve(n);
+	}
+
+	// Append a boid
+	void push(const Vec3& pos, const Vec3& vel, GLfloat wing)
+	{
+		posX.push_back(pos.x); posY.push_back(pos.y); posZ.push_back(pos.z);
+		velX.push_back(vel.x); velY.push_back(vel.y); velZ.push_back(vel.z);
+		yaw.push_back(0.0f);
+		wingAngle.push_back(wing);
+		idleTime.push_back(0.0f);
+	}
+
+	// Remove the last boid
+	void pop() { resize(size() - 1); }
+
+	// Remove boid i by moving the last boid into its slot
+	void swapErase(size_t i)
+	{
+		const size_t last = size() - 1;
+		if (i != last)
+		{
+			posX[i] = posX[last]; posY[i] = posY[last]; posZ[i] = posZ[last];
+			velX[i] = velX[last]; velY[i] = velY[last]; velZ[i] = velZ[last];
+			yaw[i] = yaw[last];
+			wingAngle[i] = wingAngle[last];
+			idleTime[i] = idleTime[last];
+		}
+		pop();
+	}
+
+	// Copy boid order[i] of 'src' into slot i, for every slot of 'order'
+	void gather(const FlockState& src, const std::vector<uint32_t>& order)
+	{
+		resize(order.size());
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			const uint32_t j = order[i];
+			posX[i] = src.posX[j]; posY[i] = src.posY[j]; posZ[i] = src.posZ[j];
+			velX[i] = src.velX[j]; velY[i] = src.velY[j]; velZ[i] = src.velZ[j];
+			yaw[i] = src.yaw[j];
+			wingAngle[i] = src.wingAngle[j];
+			idleTime[i] = src.idleTime[j];
+		}
+	}
+
+	Vec3 getPosition(size_t i) const { return Vec3(posX[i], posY[i], posZ[i]); }
+	Vec3 getVelocity(size_t i) const { return Vec3(velX[i], velY[i], velZ[i]); }
+
+	void setPosition(size_t i, const Vec3& p) { posX[i] = p.x; posY[i] = p.y; posZ[i] = p.z; }
+	void setVelocity(size_t i, const Vec3& v) { velX[i] = v.x; velY[i] = v.y; velZ[i] = v.z; }
+};
@@ -0,0 +1,206 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <functional>
+
+#include "FlowField.h"
+#include "DistanceField.h"
+
+static const GLfloat unreachable = std::numeric_limits<GLfloat>::infinity();
+static const GLfloat diagonalStep = 1.41421356f;
+
+// Neighbor offsets: the 4 sides first, then the diagonals
+static const int32_t stepX[8] = { 1, -1, 0, 0, 1, -1, 1, -1 };
+static const int32_t stepZ[8] = { 0, 0, 1, -1, 1, 1, -1, -1 };
+
+// Cell size of the grid
+void FlowField::setCellSize(GLfloat size)
+{
+	cellSize = std::max(size, 1e-2f);
+	invCellSize = 1.0f / cellSize;
+	source = nullptr;
+}
+
+// Solve toward the target if it changed cell or the distance field was rebaked
+void FlowField::update(const DistanceField& field, GLfloat targetX, GLfloat targetZ, GLfloat clearance)
+{
+	if (field.empty())
+	{
+		cost.clear();
+		source = nullptr;
+		return;
+	}
+
+	bool rebuilt = false;
+	if (source != &field || sourceTiles != field.getBakedTiles() || builtClearance != clearance)
+	{
+		buildCells(field, clearance);
+		rebuilt = true;
+	}
+
+	// Target clamped to the grid, so a leader off the floor still draws the flock
+	int32_t i = std::clamp(static_cast<int32_t>(std::floor((targetX - originX) * invCellSize)), 0, cellsX - 1);
+	int32_t j = std::clamp(static_cast<int32_t>(std::floor((targetZ - originZ) * invCellSize)), 0, cellsZ - 1);
+	int32_t target = j * cellsX + i;
+	if (rebuilt || target != targetCell)
+		solve(target);
+}
+
+// Blocked cells from the distance field, and the grid over its area
+void FlowField::buildCells(const DistanceField& field, GLfloat clearance)
+{
+	originX = field.getMinX();
+	originZ = field.getMinZ();
+	cellsX = std::max(1, static_cast<int32_t>(std::ceil((field.getMaxX() - originX) * invCellSize)));
+	cellsZ = std::max(1, static_cast<int32_t>(std::ceil((field.getMaxZ() - originZ) * invCellSize)));
+
+	const size_t count = static_cast<size_t>(cellsX) * cellsZ;
+	blocked.assign(count, 0);
+	for (int32_t j = 0; j < cellsZ; ++j)
+	{
+		for (int32_t i = 0; i < cellsX; ++i)
+		{
+			// Distance at the cell center (centers past the field's edge are clamped)
+			GLfloat x = std::min(originX + (i + 0.5f) * cellSize, field.getMaxX());
+			GLfloat z = std::min(originZ + (j + 0.5f) * cellSize, field.getMaxZ());
+			GLfloat distance, gradX, gradZ;
+			if (field.sample(x, z, distance, gradX, gradZ) && distance < clearance)
+				blocked[static_cast<size_t>(j) * cellsX + i] = 1;
+		}
+	}
+
+	cost.assign(count, unreachable);
+	dirX.assign(count, 0.0f);
+	dirZ.assign(count, 0.0f);
+	source = &field;
+	sourceTiles = field.getBakedTiles();
+	builtClearance = clearance;
+	targetCell = -1;
+}
+
+// Dijkstra from the target's cell, then the direction of every cell
+void FlowField::solve(int32_t target)
+{
+	std::fill(cost.begin(), cost.end(), unreachable);
+	std::fill(dirX.begin(), dirX.end(), 0.0f);
+	std::fill(dirZ.begin(), dirZ.end(), 0.0f);
+
+	// The target's cell is a source even when blocked (leader above an obstacle)
+	auto later = std::greater<std::pair<GLfloat, int32_t>>();
+	heap.clear();
+	cost[target] = 0.0f;
+	heap.push_back({ 0.0f, target });
+
+	while (!heap.empty())
+	{
+		std::pop_heap(heap.begin(), heap.end(), later);
+		auto [d, c] = heap.back();
+		heap.pop_back();
+		if (d > cost[c]) continue;
+
+		const int32_t ci = c % cellsX, cj = c / cellsX;
+		for (int k = 0; k < 8; ++k)
+		{
+			int32_t ni = ci + stepX[k], nj = cj + stepZ[k];
+			if (ni < 0 || nj < 0 || ni >= cellsX || nj >= cellsZ) continue;
+			int32_t n = nj * cellsX + ni;
+			if (blocked[n]) continue;
+
+			// Diagonals only between two free sides, so paths do not cut corners
+			if (k >= 4 && (blocked[cj * cellsX + ni] || blocked[nj * cellsX + ci])) continue;
+
+			GLfloat next = d + (k >= 4 ? diagonalStep : 1.0f);
+			if (next < cost[n])
+			{
+				cost[n] = next;
+				heap.push_back({ next, n });
+				std::push_heap(heap.begin(), heap.end(), later);
+			}
+		}
+	}
+
+	// Each reached cell points to the neighbor its shortest path goes through. A blocked
+	// cell next to reached ones points out to the best of them, so boids pushed
+	// against an obstacle still know which way to slide.
+	for (int32_t cj = 0; cj < cellsZ; ++cj)
+	{
+		for (int32_t ci = 0; ci < cellsX; ++ci)
+		{
+			int32_t c = cj * cellsX + ci;
+			if (c == target || (cost[c] == unreachable && !blocked[c])) continue;
+
+			GLfloat best = cost[c];
+			int bestStep = -1;
+			for (int k = 0; k < 8; ++k)
+			{
+				int32_t ni = ci + stepX[k], nj = cj + stepZ[k];
+				if (ni < 0 || nj < 0 || ni >= cellsX || nj >= cellsZ) continue;
+				if (!blocked[c] && k >= 4 && (blocked[cj * cellsX + ni] || blocked[nj * cellsX + ci])) continue;
+
+				GLfloat through = cost[nj * cellsX + ni] + (k >= 4 ? diagonalStep : 1.0f);
+				if (through < best || (through == best && through != unreachable))
+				{
+					best = through;
+					bestStep = k;
+				}
+			}
+			if (bestStep < 0) continue;
+
+			GLfloat scale = bestStep >= 4 ? 1.0f / diagonalStep : 1.0f;
+			dirX[c] = stepX[bestStep] * scale;
+			dirZ[c] = stepZ[bestStep] * scale;
+		}
+	}
+
+	targetCell = target;
+	++solveCount;
+}
+
+// Unit direction to follow at (x, z), blended between the nearby cells
+bool FlowField::sample(GLfloat x, GLfloat z, GLfloat& outX, GLfloat& outZ) const
+{
+	if (cost.empty()) return false;
+
+	GLfloat fx = (x - originX) * invCellSize;
+	GLfloat fz = (z - originZ) * invCellSize;
+	if (fx < 0.0f || fz < 0.0f || fx >= cellsX || fz >= cellsZ) return false;
+
+	int32_t ci = static_cast<int32_t>(fx), cj = static_cast<int32_t>(fz);
+	int32_t c = cj * cellsX + ci;
+	if (dirX[c] == 0.0f && dirZ[c] == 0.0f) return false;
+
+	// Bilinear blend between the 4 nearest cell centers; cells without a direction drop out
+	fx = std::clamp(fx - 0.5f, 0.0f, static_cast<GLfloat>(cellsX - 1));
+	fz = std::clamp(fz - 0.5f, 0.0f, static_cast<GLfloat>(cellsZ - 1));
+	int32_t i0 = std::min(static_cast<int32_t>(fx), std::max(cellsX - 2, 0));
+	int32_t j0 = std::min(static_cast<int32_t>(fz), std::max(cellsZ - 2, 0));
+	int32_t i1 = std::min(i0 + 1, cellsX - 1);
+	int32_t j1 = std::min(j0 + 1, cellsZ - 1);
+	GLfloat u = fx - i0, v = fz - j0;
+
+	GLfloat wa = (1.0f - u) * (1.0f - v), wb = u * (1.0f - v), wc = (1.0f - u) * v, wd = u * v;
+	int32_t a = j0 * cellsX + i0, b = j0 * cellsX + i1, cc = j1 * cellsX + i0, d = j1 * cellsX + i1;
+	GLfloat sx = wa * dirX[a] + wb * dirX[b] + wc * dirX[cc] + wd * dirX[d];
+	GLfloat sz = wa * dirZ[a] + wb * dirZ[b] + wc * dirZ[cc] + wd * dirZ[d];
+
+	// Opposite directions can cancel out: fall back to the boid's own cell
+	GLfloat len = std::sqrt(sx * sx + sz * sz);
+	if (len < 1e-3f)
+	{
+		sx = dirX[c];
+		sz = dirZ[c];
+		len = 1.0f;
+	}
+	outX = sx / len;
+	outZ = sz / len;
+	return true;
+}
+
+// Bytes held by the field
+size_t FlowField::getMemoryUsage() const
+{
+	size_t bytes = blocked.capacity();
+	bytes += (cost.capacity() + dirX.capacity() + dirZ.capacity()) * sizeof(GLfloat);
+	bytes += heap.capacity() * sizeof(heap[0]);
+	return bytes;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <GL/glut.h>
+
+class DistanceField;
+
+// Flow field toward a target on a coarse grid of the XZ plane: the shortest path
+// distance from every cell to the target's cell around the obstacles (Dijkstra over
+// the 8 neighbors, no corner cutting), and the direction to take from each cell.
+// Blocked cells come from a distance field, so the field covers the same area.
+// One solve serves every boid, each lookup is O(1).
+class FlowField
+{
+public:
+	FlowField() = default;
+	~FlowField() = default;
+
+	// Cell size of the grid (the blocked cells are recomputed on the next update)
+	void setCellSize(GLfloat size);
+	GLfloat getCellSize() const { return cellSize; }
+
+	// Solve toward (targetX, targetZ) if the target changed cell or the distance field
+	// was rebaked since the last solve; cells closer than clearance to a surface are blocked
+	void update(const DistanceField& field, GLfloat targetX, GLfloat targetZ, GLfloat clearance);
+
+	// Unit direction to follow at (x, z), blended between the nearby cells; false
+	// outside the field, in the target's cell and in cells with no way to the target
+	bool sample(GLfloat x, GLfloat z, GLfloat& dirX, GLfloat& dirZ) const;
+
+	bool empty() const { return cost.empty(); }
+
+	// Solves so far
+	uint64_t getSolveCount() const { return solveCount; }
+
+	// Bytes held by the field
+	size_t getMemoryUsage() const;
+
+private:
+	// Blocked cells from the distance field, and the grid over its area
+	void buildCells(const DistanceField& field, GLfloat clearance);
+
+	// Dijkstra from cell 'target', then the direction of every cell
+	void solve(int32_t target);
+
+	GLfloat cellSize = 8.0f;					// Cell side
+	GLfloat invCellSize = 1.0f / 8.0f;
+	GLfloat originX = 0.0f, originZ = 0.0f;		// Corner of the first cell
+	int32_t cellsX = 0, cellsZ = 0;				// Cells per axis
+
+	const DistanceField* source = nullptr;		// Field the blocked cells come from
+	uint64_t sourceTiles = 0;					// Its baked tile count at that time
+	GLfloat builtClearance = -1.0f;				// Clearance of the blocked cells
+	int32_t targetCell = -1;					// Cell of the last solve
+	uint64_t solveCount = 0;					// Solves so far
+
+	std::vector<uint8_t> blocked;		// Cells too close to an obstacle or the tower
+	std::vector<GLfloat> cost;			// Path length to the target (infinity if unreachable)
+	std::vector<GLfloat> dirX, dirZ;	// Direction to follow (zero in the target and cut-off cells)
+	std::vector<std::pair<GLfloat, int32_t>> heap;	// Dijkstra queue (scratch)
+};
@@ -15,6 +15,7 @@ std::vector<std::string> prepareHUDLines()
 	hudLines.push_back("Controls:");
 	hudLines.push_back("Arrow Keys/WASD: Control Boid Leader");
 	hudLines.push_back("+/-: Add/Remove Boids");
+	hudLines.push_back("K: Toggle Nearest-Neighbor Flocking");
 	hudLines.push_back("Z: Stop Boid Leader");
 	hudLines.push_back("Q/E: Increase/Decrease Height");
 	hudLines.push_back("O/P: Add/Remove Obstacle");
@@ -0,0 +1,211 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <algorithm>
+#include <vector>
+
+#include "Headless.h"
+#include "Flock.h"
+#include "Philox.h"
+
+// Parse "--headless [boids] [steps] [threads]" or "--check [boids] [steps] [threads]"
+// from the command line
+bool parseHeadlessOptions(int argc, char* argv[], HeadlessOptions& options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool check = std::strcmp(argv[i], "--check") == 0;
+		if (!check && std::strcmp(argv[i], "--headless") != 0) continue;
+
+		// The check runs brute force configurations: a small flock by default
+		options.check = check;
+		if (check)
+		{
+			options.boidCount = 2000;
+			options.steps = 300;
+		}
+
+		// Optional positional values
+		if (i + 1 < argc) options.boidCount = std::max(1, std::atoi(argv[i + 1]));
+		if (i + 2 < argc) options.steps = std::max(1, std::atoi(argv[i + 2]));
+		if (i + 3 < argc) options.maxThreads = static_cast<unsigned>(std::max(0, std::atoi(argv[i + 3])));
+		return true;
+	}
+	return false;
+}
+
+// Spread of a flock in which each boid has about ten others inside the separation radius
+static GLfloat flockSpread(int boidCount)
+{
+	BoidParams params;
+	const GLfloat areaPerBoid = PI * params.separationRadius * params.separationRadius / 10.0f;
+	return 0.5f * std::sqrt(boidCount * areaPerBoid);
+}
+
+// Run the flock without a window and print steps per second for 1, 2, 4, ... threads
+int runHeadless(const HeadlessOptions& options)
+{
+	unsigned maxThreads = options.maxThreads;
+	if (maxThreads == 0) maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	const GLfloat spread = flockSpread(options.boidCount);
+
+	std::cout << "Headless flock: " << options.boidCount << " boids, "
+		<< options.steps << " steps, dt = " << options.dt << " s" << std::endl;
+	std::cout << std::setw(8) << "threads"
+		<< std::setw(12) << "ms/step"
+		<< std::setw(12) << "steps/s"
+		<< std::setw(16) << "Mboid-steps/s"
+		<< std::setw(10) << "speedup"
+		<< std::setw(12) << "MB" << std::endl;
+
+	double baseSeconds = 0.0;
+	for (unsigned threads = 1; ; threads = std::min(threads * 2, maxThreads))
+	{
+		// Same seed for every run so all thread counts simulate the same flock
+		Flock flock;
+		flock.setMaxBoids(options.boidCount);
+		flock.setThreadCount(threads);
+		flock.setNeighborSkin(3.0f);	// Verlet lists, as in the interactive flock
+		flock.init(options.boidCount, nullptr, spread, options.seed);
+
+		// Warm-up step sizes the scratch buffers; timed steps do not allocate
+		flock.update(options.dt);
+
+		auto start = std::chrono::steady_clock::now();
+		for (int s = 0; s < options.steps; ++s)
+			flock.update(options.dt);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if (threads == 1) baseSeconds = seconds;
+		double perStep = seconds / options.steps;
+		std::cout << std::fixed << std::setprecision(2)
+			<< std::setw(8) << threads
+			<< std::setw(12) << perStep * 1000.0
+			<< std::setw(12) << 1.0 / perStep
+			<< std::setw(16) << options.boidCount / perStep * 1e-6
+			<< std::setw(10) << baseSeconds / seconds
+			<< std::setw(12) << flock.getMemoryUsage() / (1024.0 * 1024.0)
+			<< std::endl;
+
+		if (threads >= maxThreads) break;
+	}
+	return 0;
+}
+
+// One flock configuration of the determinism check
+struct CheckRun
+{
+	const char* name;		// Printed name
+	SpatialIndex index;		// Structure for the metric queries
+	GLfloat skin;			// Verlet list skin (0 = no lists)
+	bool simd;				// SIMD neighbor kernel
+	bool threaded;			// Many threads instead of one
+};
+
+// State hash of the flock after the check's steps in one configuration
+static uint64_t runCheckFlock(const HeadlessOptions& options, const CheckRun& run, unsigned threads)
+{
+	Flock flock;
+	flock.setMaxBoids(options.boidCount);
+	flock.setThreadCount(run.threaded ? threads : 1);
+	flock.setSpatialIndex(run.index);
+	flock.setNeighborSkin(run.skin);
+	flock.setSimdSteering(run.simd);
+	flock.init(options.boidCount, nullptr, flockSpread(options.boidCount), options.seed);
+
+	for (int s = 0; s < options.steps; ++s)
+		flock.update(options.dt);
+	return flock.getStateHash();
+}
+
+// Print the result of one check and return 1 on failure
+static int reportCheck(const char* name, bool passed)
+{
+	std::cout << "  " << std::left << std::setw(44) << name << std::right
+		<< (passed ? "ok" : "MISMATCH") << std::endl;
+	return passed ? 0 : 1;
+}
+
+// Run the flock in the configurations that must give bitwise identical states
+int runDeterminismCheck(const HeadlessOptions& options)
+{
+	// At least two threads, so that the threaded runs split the work
+	unsigned threads = options.maxThreads;
+	if (threads == 0) threads = std::thread::hardware_concurrency();
+	threads = std::max(2u, threads);
+
+	std::cout << "Determinism check: " << options.boidCount << " boids, "
+		<< options.steps << " steps, seed " << options.seed << ", "
+		<< threads << " threads" << std::endl;
+	int failures = 0;
+
+	// Philox4x32-10 known answer (Random123): key 0, counter 0
+	{
+		const Philox::Block expected = { 0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u };
+		failures += reportCheck("Philox4x32-10 known answer", Philox(0)(0) == expected);
+	}
+
+	// A removed boid's handle stops resolving, also once its entry is reused
+	{
+		Flock flock;
+		flock.setThreadCount(1);
+		flock.init(20, nullptr, 10.0f, options.seed);
+		const BoidHandle handle = flock.getHandle(0);
+		const bool removed = flock.removeBoid(handle);
+		const bool removedTwice = flock.removeBoid(handle);
+		flock.spawn(1, { Zero, Vec3(10.0f, 1.0f, 10.0f) }, options.seed);
+		const BoidHandle fresh = flock.getHandle(flock.getBoidCount() - 1);
+		const bool reused = (fresh & 0xffffffffu) == (handle & 0xffffffffu) && fresh != handle;
+		failures += reportCheck("Stale boid handles", removed && !removedTwice && flock.findBoid(handle) == -1 && reused);
+	}
+
+	// Each group must agree with its first run:
+	//  - the scalar kernel sums the neighbors in index order, from every boid (brute
+	//    force), from the grid and quadtree candidates, and from the Verlet lists of
+	//    any index, however often the drift test rebuilds them;
+	//  - the SIMD kernel sees the same lists from every index; without lists its sums
+	//    depend on which candidates share a block, so only the thread count varies;
+	//  - any configuration gives the same state for any thread count.
+	const std::vector<std::vector<CheckRun>> groups = {
+		{
+			{ "scalar, brute force", SpatialIndex::BruteForce, 0.0f, false, false },
+			{ "scalar, grid", SpatialIndex::Grid, 0.0f, false, false },
+			{ "scalar, quadtree", SpatialIndex::QuadTree, 0.0f, false, false },
+			{ "scalar, grid, threaded", SpatialIndex::Grid, 0.0f, false, true },
+			{ "scalar, grid lists", SpatialIndex::Grid, 3.0f, false, false },
+			{ "scalar, quadtree lists", SpatialIndex::QuadTree, 3.0f, false, false },
+			{ "scalar, brute force lists", SpatialIndex::BruteForce, 3.0f, false, false },
+			{ "scalar, grid lists, threaded", SpatialIndex::Grid, 3.0f, false, true },
+		},
+		{
+			{ "SIMD, grid lists", SpatialIndex::Grid, 3.0f, true, false },
+			{ "SIMD, quadtree lists", SpatialIndex::QuadTree, 3.0f, true, false },
+			{ "SIMD, brute force lists", SpatialIndex::BruteForce, 3.0f, true, false },
+			{ "SIMD, grid lists, threaded", SpatialIndex::Grid, 3.0f, true, true },
+		},
+		{
+			{ "SIMD, grid", SpatialIndex::Grid, 0.0f, true, false },
+			{ "SIMD, grid, threaded", SpatialIndex::Grid, 0.0f, true, true },
+		},
+		{
+			{ "SIMD, quadtree", SpatialIndex::QuadTree, 0.0f, true, false },
+			{ "SIMD, quadtree, threaded", SpatialIndex::QuadTree, 0.0f, true, true },
+		},
+	};
+
+	for (const auto& group : groups)
+	{
+		const uint64_t reference = runCheckFlock(options, group[0], threads);
+		std::cout << "  " << group[0].name << ": hash " << std::hex << std::setfill('0')
+			<< std::setw(16) << reference << std::dec << std::setfill(' ') << std::endl;
+		for (size_t r = 1; r < group.size(); ++r)
+			failures += reportCheck(group[r].name, runCheckFlock(options, group[r], threads) == reference);
+	}
+
+	std::cout << (failures == 0 ? "All checks passed" : "Some checks FAILED") << std::endl;
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+// Headless flock benchmark settings
+struct HeadlessOptions
+{
+	int boidCount = 1000000;	// Number of boids
+	int steps = 100;			// Timed steps per run
+	unsigned maxThreads = 0;	// Largest thread count of the scaling report (0 = hardware concurrency)
+	unsigned int seed = 1;		// Seed of the initial flock
+	float dt = 1.0f / 60.0f;	// Simulation step
+	bool check = false;			// Run the determinism check instead of the benchmark
+};
+
+// Parse "--headless [boids] [steps] [threads]" or "--check [boids] [steps] [threads]"
+// from the command line. Returns false if neither mode was requested.
+bool parseHeadlessOptions(int argc, char* argv[], HeadlessOptions& options);
+
+// Run the flock without a window and print steps per second for 1, 2, 4, ... threads
+int runHeadless(const HeadlessOptions& options);
+
+// Run the flock without a window in the configurations that must give bitwise identical
+// states and compare their state hashes. Returns 0 if all of them agree, 1 otherwise.
+int runDeterminismCheck(const HeadlessOptions& options);
@@ -0,0 +1,88 @@
+#include "IndexSelector.h"
+
+// Index to use for the next update of n boids
+SpatialIndex IndexSelector::next(size_t n)
+{
+	if (!started)
+	{
+		current = n < smallFlock ? SpatialIndex::BruteForce : SpatialIndex::Grid;
+		started = true;
+	}
+	if (!allowed(current, n)) current = SpatialIndex::Grid;
+
+	if (probeStepsLeft > 0 && allowed(probing, n)) return probing;
+	probeStepsLeft = 0;
+
+	// Probe an index never measured or measured too long ago
+	for (int k = 0; k < indexCount; ++k)
+	{
+		SpatialIndex index = static_cast<SpatialIndex>(k);
+		if (index == current || !allowed(index, n)) continue;
+		const Estimate& e = estimates[k];
+		if (e.samples == 0 || step - e.lastStep > probeInterval)
+		{
+			probing = index;
+			probeStepsLeft = probeSteps;
+			return probing;
+		}
+	}
+	return current;
+}
+
+// Cost of an update of n boids with 'index'
+void IndexSelector::record(SpatialIndex index, double seconds, size_t n, GLfloat crowding)
+{
+	++step;
+
+	// The flock clustered or spread out: the measurements no longer hold
+	if (crowding > 0.0f)
+	{
+		if (lastCrowding > 0.0f && (crowding > 2.0f * lastCrowding || 2.0f * crowding < lastCrowding))
+		{
+			for (auto& e : estimates)
+				e.samples = 0;
+		}
+		lastCrowding = crowding;
+	}
+
+	Estimate& e = estimates[static_cast<int>(index)];
+	double cost = seconds / static_cast<double>(n > 0 ? n : 1);
+	e.costPerBoid = e.samples == 0 ? cost : e.costPerBoid + smoothing * (cost - e.costPerBoid);
+	++e.samples;
+	e.lastStep = step;
+
+	if (probeStepsLeft > 0 && index == probing && --probeStepsLeft > 0) return;
+
+	// Switch to the cheapest measured index if it is clearly cheaper
+	const Estimate& cur = estimates[static_cast<int>(current)];
+	if (cur.samples == 0 || (lastSwitch != 0 && step - lastSwitch < minDwell)) return;
+
+	int best = static_cast<int>(current);
+	for (int k = 0; k < indexCount; ++k)
+	{
+		const Estimate& other = estimates[k];
+		if (other.samples == 0 || !allowed(static_cast<SpatialIndex>(k), n)) continue;
+		if (other.costPerBoid < estimates[best].costPerBoid) best = k;
+	}
+	if (estimates[best].costPerBoid < cur.costPerBoid * (1.0 - hysteresis))
+	{
+		current = static_cast<SpatialIndex>(best);
+		lastSwitch = step;
+	}
+}
+
+// Forget all measurements
+void IndexSelector::reset()
+{
+	for (auto& e : estimates)
+		e = Estimate();
+	started = false;
+	probeStepsLeft = 0;
+	lastCrowding = -1.0f;
+	lastSwitch = 0;
+}
+
+bool IndexSelector::allowed(SpatialIndex index, size_t n) const
+{
+	return index != SpatialIndex::BruteForce || n <= bruteForceLimit;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <GL/glut.h>
+
+#include "NeighborList.h"
+
+// Picks the spatial index of metric flock updates at runtime.
+// Every index the flock size allows is probed for a few updates now and then, and the
+// measured cost per boid decides; the current index is only replaced by one that is
+// clearly cheaper, and not again before a minimum dwell, so the choice does not flap.
+// A large change in grid crowding (clustering) makes all measurements stale.
+class IndexSelector
+{
+public:
+	IndexSelector() = default;
+	~IndexSelector() = default;
+
+	// Index to use for the next update of n boids
+	SpatialIndex next(size_t n);
+
+	// Cost of an update of n boids with 'index'; crowding is the grid's mean bucket
+	// load seen by a boid, whichever index ran, or a negative value if unknown
+	void record(SpatialIndex index, double seconds, size_t n, GLfloat crowding);
+
+	// Forget all measurements
+	void reset();
+
+	SpatialIndex getCurrent() const { return current; }
+
+private:
+	// Smoothed cost of one index
+	struct Estimate
+	{
+		double costPerBoid = 0.0;	// Seconds per boid and update
+		int samples = 0;			// Updates measured since the last reset
+		uint64_t lastStep = 0;		// Update of the last measurement
+	};
+
+	static const int indexCount = 3;
+	static const size_t smallFlock = 256;		// Brute force is the first guess below this
+	static const size_t bruteForceLimit = 2048;	// Brute force is never tried above this
+	static const uint64_t probeInterval = 300;	// Updates before a measurement is stale
+	static const int probeSteps = 8;			// Updates per probe
+	static const uint64_t minDwell = 60;		// Updates between switches
+	static constexpr double hysteresis = 0.15;	// Required relative gain to switch
+	static constexpr double smoothing = 0.25;	// Weight of a new measurement
+
+	bool allowed(SpatialIndex index, size_t n) const;
+
+	Estimate estimates[indexCount];
+	SpatialIndex current = SpatialIndex::Grid;	// Index in use
+	SpatialIndex probing = SpatialIndex::Grid;	// Index being probed
+	int probeStepsLeft = 0;						// Updates left in the probe
+	bool started = false;						// 'current' was picked
+	uint64_t step = 0;							// Updates measured
+	uint64_t lastSwitch = 0;					// Update of the last switch (0 = none)
+	GLfloat lastCrowding = -1.0f;				// Crowding at the last measurement
+};
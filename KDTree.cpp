@@ -0,0 +1,92 @@
+#include <algorithm>
+
+#include "KDTree.h"
+
+// Rebuild the tree from n points (x[i], z[i])
+void KDTree::build(const GLfloat* x, const GLfloat* z, size_t n)
+{
+	px = x;
+	pz = z;
+
+	order.resize(n);
+	for (size_t i = 0; i < n; ++i)
+		order[i] = static_cast<uint32_t>(i);
+
+	nodes.clear();
+	if (n > 0) buildNode(0, static_cast<uint32_t>(n), 0);
+}
+
+// Split order[begin, end) at the median of the alternating axis
+uint32_t KDTree::buildNode(uint32_t begin, uint32_t end, int depth)
+{
+	uint32_t id = static_cast<uint32_t>(nodes.size());
+	nodes.push_back({ begin, end, 0, 0, 0.0f, static_cast<uint8_t>(depth & 1) });
+	if (end - begin <= leafSize) return id;
+
+	const GLfloat* coord = (depth & 1) ? pz : px;
+	uint32_t mid = begin + (end - begin) / 2;
+	std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+		[coord](uint32_t a, uint32_t b) { return coord[a] < coord[b] || (coord[a] == coord[b] && a < b); });
+
+	nodes[id].split = coord[order[mid]];
+	uint32_t left = buildNode(begin, mid, depth + 1);
+	uint32_t right = buildNode(mid, end, depth + 1);
+	nodes[id].left = left;
+	nodes[id].right = right;
+	return id;
+}
+
+// Append to 'out' the k points nearest to (x, z), closest first, skipping 'exclude'
+void KDTree::nearest(GLfloat x, GLfloat z, size_t k, uint32_t exclude, std::vector<uint32_t>& out) const
+{
+	if (nodes.empty() || k == 0) return;
+
+	// Max-heap of the best k candidates so far
+	thread_local std::vector<Candidate> heap;
+	heap.clear();
+	search(0, x, z, k, exclude, heap);
+
+	std::sort_heap(heap.begin(), heap.end());
+	for (auto& c : heap)
+		out.push_back(c.index);
+}
+
+void KDTree::search(uint32_t id, GLfloat x, GLfloat z, size_t k, uint32_t exclude, std::vector<Candidate>& heap) const
+{
+	const Node& node = nodes[id];
+
+	if (node.left == 0)
+	{
+		// Leaf: test every point
+		for (uint32_t e = node.begin; e < node.end; ++e)
+		{
+			uint32_t i = order[e];
+			if (i == exclude) continue;
+			GLfloat dx = px[i] - x;
+			GLfloat dz = pz[i] - z;
+			Candidate c = { dx * dx + dz * dz, i };
+
+			if (heap.size() < k)
+			{
+				heap.push_back(c);
+				std::push_heap(heap.begin(), heap.end());
+			}
+			else if (c < heap.front())
+			{
+				std::pop_heap(heap.begin(), heap.end());
+				heap.back() = c;
+				std::push_heap(heap.begin(), heap.end());
+			}
+		}
+		return;
+	}
+
+	// Visit the side containing the query first, then the other if it can still hold closer points
+	GLfloat delta = (node.axis ? z : x) - node.split;
+	uint32_t nearSide = delta < 0.0f ? node.left : node.right;
+	uint32_t farSide = delta < 0.0f ? node.right : node.left;
+
+	search(nearSide, x, z, k, exclude, heap);
+	if (heap.size() < k || delta * delta <= heap.front().d2)
+		search(farSide, x, z, k, exclude, heap);
+}
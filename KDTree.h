@@ -0,0 +1,47 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <GL/glut.h>
+
+// 2D k-d tree over the XZ plane used for k-nearest-neighbor boid queries
+class KDTree
+{
+public:
+	KDTree() = default;
+	~KDTree() = default;
+
+	// Rebuild the tree from n points (x[i], z[i]); the arrays must outlive the queries
+	void build(const GLfloat* x, const GLfloat* z, size_t n);
+
+	// Append to 'out' the k points nearest to (x, z), closest first, skipping 'exclude'.
+	// Ties are broken by index, so the result does not depend on the tree layout.
+	void nearest(GLfloat x, GLfloat z, size_t k, uint32_t exclude, std::vector<uint32_t>& out) const;
+
+private:
+	// Tree node covering order[begin, end)
+	struct Node
+	{
+		uint32_t begin, end;	// Range of points in 'order'
+		uint32_t left, right;	// Child nodes (0 for a leaf)
+		GLfloat split;			// Split coordinate
+		uint8_t axis;			// 0 = x, 1 = z
+	};
+
+	// Candidate found by a query
+	struct Candidate
+	{
+		GLfloat d2;
+		uint32_t index;
+		bool operator<(const Candidate& o) const { return d2 < o.d2 || (d2 == o.d2 && index < o.index); }
+	};
+
+	uint32_t buildNode(uint32_t begin, uint32_t end, int depth);
+	void search(uint32_t node, GLfloat x, GLfloat z, size_t k, uint32_t exclude, std::vector<Candidate>& heap) const;
+
+	static const uint32_t leafSize = 8;	// Maximum points in a leaf
+
+	const GLfloat* px = nullptr;	// Point coordinates
+	const GLfloat* pz = nullptr;
+	std::vector<uint32_t> order;	// Point indices grouped by node
+	std::vector<Node> nodes;		// Nodes, root first
+};
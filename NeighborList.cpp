@@ -0,0 +1,135 @@
+#include <algorithm>
+
+#include "NeighborList.h"
+
+// True if the lists no longer cover every neighbor within radius
+bool NeighborList::needsRebuild(const FlockState& state, GLfloat radius) const
+{
+	const size_t n = refX.size();
+	if (!valid || radius != builtRadius || n != state.size()) return true;
+	if (n == 0) return false;
+
+	const GLfloat* x = state.posX.data();
+	const GLfloat* z = state.posZ.data();
+
+	// The lists only hold relative distances, so the flock drifting as a whole does not
+	// invalidate them: measure each displacement from the mean displacement
+	double sumX = 0.0, sumZ = 0.0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		sumX += x[i] - refX[i];
+		sumZ += z[i] - refZ[i];
+	}
+	const GLfloat driftX = static_cast<GLfloat>(sumX / n);
+	const GLfloat driftZ = static_cast<GLfloat>(sumZ / n);
+
+	// Two boids each moving half the skin can close the whole skin
+	const GLfloat limit2 = 0.25f * skin * skin;
+	for (size_t i = 0; i < n; ++i)
+	{
+		GLfloat dx = x[i] - refX[i] - driftX;
+		GLfloat dz = z[i] - refZ[i] - driftZ;
+		if (dx * dx + dz * dz > limit2) return true;
+	}
+	return false;
+}
+
+// Rebuild the lists from the current positions
+void NeighborList::build(const FlockState& state, GLfloat radius, ThreadPool& pool)
+{
+	const size_t n = state.size();
+	const GLfloat* x = state.posX.data();
+	const GLfloat* z = state.posZ.data();
+	const GLfloat reach = radius + skin;
+	const GLfloat reach2 = reach * reach;
+
+	refX.assign(state.posX.begin(), state.posX.end());
+	refZ.assign(state.posZ.begin(), state.posZ.end());
+	const bool useTree = spatialIndex == SpatialIndex::QuadTree;
+	const bool useAll = spatialIndex == SpatialIndex::BruteForce;
+	if (useTree) quadTree.build(x, z, n);
+	else if (!useAll) grid.build(x, z, n, reach);
+	if (useAll && allPoints.size() != n)
+	{
+		allPoints.resize(n);
+		for (size_t i = 0; i < n; ++i)
+			allPoints[i] = static_cast<uint32_t>(i);
+	}
+	candidates.resize(pool.getThreadCount());
+	workerEntries.resize(pool.getThreadCount());
+	for (auto& list : workerEntries)
+		list.clear();
+	offsets.resize(n + 1);
+	chunks.resize((n + buildGrain - 1) / buildGrain);
+
+	// Keep the candidates within reach, in index order so that the lists do not
+	// depend on the structure that built them. Each chunk appends its lists to its
+	// worker's buffer and records where they went.
+	pool.parallelFor(n, buildGrain, [&](size_t begin, size_t end, unsigned worker)
+	{
+		std::vector<uint32_t>& list = candidates[worker];
+		std::vector<uint32_t>& out = workerEntries[worker];
+		for (size_t i = begin; i < end; ++i)
+		{
+			// The range is a whole number of chunks (one range without workers)
+			if (i % buildGrain == 0)
+				chunks[i / buildGrain] = { worker, static_cast<uint32_t>(out.size()) };
+
+			list.clear();
+			if (useTree)
+				quadTree.query(x[i], z[i], reach, list);
+			else if (useAll)
+				list.insert(list.end(), allPoints.begin(), allPoints.end());
+			else
+				grid.query(x[i], z[i], list);
+
+			size_t first = out.size();
+			for (uint32_t j : list)
+			{
+				if (j == i) continue;
+				GLfloat dx = x[i] - x[j];
+				GLfloat dz = z[i] - z[j];
+				if (dx * dx + dz * dz < reach2) out.push_back(j);
+			}
+			std::sort(out.begin() + first, out.end());
+			offsets[i + 1] = static_cast<uint32_t>(out.size() - first);
+		}
+	});
+
+	// Prefix sum of the counts into offsets
+	offsets[0] = 0;
+	for (size_t i = 0; i < n; ++i)
+		offsets[i + 1] += offsets[i];
+	entries.resize(offsets[n]);
+
+	// Gather the chunks in boid order
+	pool.parallelFor(chunks.size(), 1, [&](size_t begin, size_t end, unsigned)
+	{
+		for (size_t c = begin; c < end; ++c)
+		{
+			size_t first = offsets[c * buildGrain];
+			size_t last = offsets[std::min(n, (c + 1) * buildGrain)];
+			const uint32_t* src = workerEntries[chunks[c].worker].data() + chunks[c].offset;
+			std::copy(src, src + (last - first), entries.data() + first);
+		}
+	});
+
+	builtRadius = radius;
+	valid = true;
+	++buildCount;
+}
+
+// Bytes held by the lists
+size_t NeighborList::getMemoryUsage() const
+{
+	size_t bytes = (refX.capacity() + refZ.capacity()) * sizeof(GLfloat);
+	bytes += (offsets.capacity() + entries.capacity()) * sizeof(uint32_t);
+	bytes += grid.getMemoryUsage();
+	bytes += quadTree.getMemoryUsage();
+	bytes += (chunks.capacity() * sizeof(Chunk)) + allPoints.capacity() * sizeof(uint32_t);
+	for (auto& list : candidates)
+		bytes += list.capacity() * sizeof(uint32_t);
+	for (auto& list : workerEntries)
+		bytes += list.capacity() * sizeof(uint32_t);
+	return bytes;
+}
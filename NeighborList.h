@@ -0,0 +1,84 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <GL/glut.h>
+
+#include "FlockState.h"
+#include "SpatialGrid.h"
+#include "QuadTree.h"
+#include "ThreadPool.h"
+
+// Structure used to find the boids within a radius
+enum class SpatialIndex
+{
+	Grid,		// Uniform hash grid with cells of the radius
+	QuadTree,	// Adaptive quadtree, for strongly clustered flocks
+	BruteForce	// Every boid against every boid, for small flocks
+};
+
+// Verlet neighbor lists: for every boid, the boids within radius + skin when the lists
+// were built. While no boid has moved more than half the skin since then (relative to
+// the flock's mean motion), the lists still hold every neighbor within radius.
+// Each list is in index order.
+class NeighborList
+{
+public:
+	NeighborList() = default;
+	~NeighborList() = default;
+
+	// Extra distance added to the radius when building (0 disables the lists)
+	void setSkin(GLfloat s) { skin = s; invalidate(); }
+	GLfloat getSkin() const { return skin; }
+	bool isEnabled() const { return skin > 0.0f; }
+
+	// Structure used to build the lists
+	void setSpatialIndex(SpatialIndex index) { spatialIndex = index; }
+
+	// Mean bucket load seen by a boid in the grid of the last build (-1 without a grid)
+	GLfloat getCrowding() const { return spatialIndex == SpatialIndex::Grid && valid ? grid.getCrowding() : -1.0f; }
+
+	// Force a rebuild on the next update (boids added, removed or reordered)
+	void invalidate() { valid = false; }
+
+	// True if the lists no longer cover every neighbor within radius
+	bool needsRebuild(const FlockState& state, GLfloat radius) const;
+
+	// Rebuild the lists from the current positions
+	void build(const FlockState& state, GLfloat radius, ThreadPool& pool);
+
+	// Neighbors of boid i
+	const uint32_t* getNeighbors(size_t i) const { return entries.data() + offsets[i]; }
+	size_t getCount(size_t i) const { return offsets[i + 1] - offsets[i]; }
+
+	// Number of rebuilds so far
+	uint64_t getBuildCount() const { return buildCount; }
+
+	// Bytes held by the lists
+	size_t getMemoryUsage() const;
+
+private:
+	// Where a build chunk stored its lists
+	struct Chunk
+	{
+		uint32_t worker;	// Worker buffer holding the lists
+		uint32_t offset;	// Start of the lists in that buffer
+	};
+
+	static const size_t buildGrain = 512;	// Boids per build chunk
+
+	GLfloat skin = 0.0f;			// Extra build distance (0 = disabled)
+	GLfloat builtRadius = 0.0f;		// Radius the lists were built for
+	bool valid = false;				// Lists match the current boids
+	uint64_t buildCount = 0;		// Number of rebuilds
+
+	SpatialIndex spatialIndex = SpatialIndex::Grid;	// Structure used to build the lists
+	SpatialGrid grid;						// Grid used to build the lists
+	QuadTree quadTree;						// Quadtree used to build the lists
+	std::vector<GLfloat> refX, refZ;		// Positions at build time
+	std::vector<uint32_t> offsets;			// Start of each boid's list in 'entries' (n + 1)
+	std::vector<uint32_t> entries;			// All lists, boid after boid
+	std::vector<uint32_t> allPoints;		// 0 .. n - 1 (brute force)
+	std::vector<Chunk> chunks;				// Build chunks, in boid order
+	std::vector<std::vector<uint32_t>> candidates;		// Grid candidates, one list per worker
+	std::vector<std::vector<uint32_t>> workerEntries;	// Lists written by each worker
+};
@@ -0,0 +1,127 @@
+#include <algorithm>
+
+#include "ObstacleBVH.h"
+#include "Obstacle.h"
+
+// Rebuild from the collidable obstacles
+void ObstacleBVH::build(const std::vector<Obstacle>& obstacles)
+{
+	boxes.clear();
+	nodes.clear();
+	sourceCount = obstacles.size();
+
+	for (size_t i = 0; i < obstacles.size(); ++i)
+	{
+		const Obstacle& obs = obstacles[i];
+		if (!obs.canCollide()) continue;
+		Vec3 pos = obs.getPosition();
+		Vec3 half = obs.getSize() * 0.5f;
+		boxes.push_back({ pos.x - half.x, pos.z - half.z, pos.x + half.x, pos.z + half.z,
+			pos.x, pos.z, half.x, half.z, pos.y - half.y, pos.y + half.y, static_cast<uint32_t>(i) });
+	}
+
+	if (!boxes.empty()) buildNode(0, static_cast<uint32_t>(boxes.size()), 0);
+
+	// Pack the leaves, each padded to whole blocks with unreachable boxes
+	const GLfloat far = 1e30f;
+	packed.centerX.clear();
+	packed.centerZ.clear();
+	packed.halfX.clear();
+	packed.halfZ.clear();
+	packed.bottomY.clear();
+	packed.topY.clear();
+	packed.obstacle.clear();
+	for (Node& node : nodes)
+	{
+		if (node.left != 0) continue;
+		node.packedBegin = static_cast<uint32_t>(packed.size());
+		for (uint32_t i = node.begin; i < node.end; ++i)
+		{
+			const Box& b = boxes[i];
+			packed.centerX.push_back(b.centerX);
+			packed.centerZ.push_back(b.centerZ);
+			packed.halfX.push_back(b.halfX);
+			packed.halfZ.push_back(b.halfZ);
+			packed.bottomY.push_back(b.bottomY);
+			packed.topY.push_back(b.topY);
+			packed.obstacle.push_back(b.obstacle);
+		}
+		while (packed.size() % PackedBoxes::blockSize != 0)
+		{
+			packed.centerX.push_back(far);
+			packed.centerZ.push_back(far);
+			packed.halfX.push_back(0.0f);
+			packed.halfZ.push_back(0.0f);
+			packed.bottomY.push_back(far);
+			packed.topY.push_back(-far);
+			packed.obstacle.push_back(UINT32_MAX);
+		}
+		node.packedEnd = static_cast<uint32_t>(packed.size());
+	}
+}
+
+// Split boxes[begin, end) at the median center along the longer side of their bounds
+uint32_t ObstacleBVH::buildNode(uint32_t begin, uint32_t end, int depth)
+{
+	uint32_t id = static_cast<uint32_t>(nodes.size());
+	Node node = { boxes[begin].minX, boxes[begin].minZ, boxes[begin].maxX, boxes[begin].maxZ, begin, end, 0, 0, 0, 0 };
+	for (uint32_t i = begin + 1; i < end; ++i)
+	{
+		node.minX = std::min(node.minX, boxes[i].minX);
+		node.minZ = std::min(node.minZ, boxes[i].minZ);
+		node.maxX = std::max(node.maxX, boxes[i].maxX);
+		node.maxZ = std::max(node.maxZ, boxes[i].maxZ);
+	}
+	nodes.push_back(node);
+	if (end - begin <= leafSize || depth >= maxDepth) return id;
+
+	const bool splitX = node.maxX - node.minX >= node.maxZ - node.minZ;
+	uint32_t mid = begin + (end - begin) / 2;
+	std::nth_element(boxes.begin() + begin, boxes.begin() + mid, boxes.begin() + end,
+		[splitX](const Box& a, const Box& b)
+		{
+			GLfloat ca = splitX ? a.minX + a.maxX : a.minZ + a.maxZ;
+			GLfloat cb = splitX ? b.minX + b.maxX : b.minZ + b.maxZ;
+			return ca < cb || (ca == cb && a.obstacle < b.obstacle);
+		});
+
+	uint32_t left = buildNode(begin, mid, depth + 1);
+	uint32_t right = buildNode(mid, end, depth + 1);
+	nodes[id].left = left;
+	nodes[id].right = right;
+	return id;
+}
+
+// Append the obstacles whose XZ box overlaps the query box, in ascending order
+void ObstacleBVH::query(GLfloat minX, GLfloat minZ, GLfloat maxX, GLfloat maxZ, std::vector<uint32_t>& out) const
+{
+	if (nodes.empty()) return;
+
+	const size_t first = out.size();
+	uint32_t stack[2 * maxDepth + 2];
+	int top = 0;
+	stack[top++] = 0;
+
+	while (top > 0)
+	{
+		const Node& node = nodes[stack[--top]];
+		if (node.maxX < minX || node.minX > maxX || node.maxZ < minZ || node.minZ > maxZ) continue;
+
+		if (node.left != 0)
+		{
+			stack[top++] = node.right;
+			stack[top++] = node.left;
+			continue;
+		}
+
+		for (uint32_t i = node.begin; i < node.end; ++i)
+		{
+			const Box& b = boxes[i];
+			if (b.maxX < minX || b.minX > maxX || b.maxZ < minZ || b.minZ > maxZ) continue;
+			out.push_back(b.obstacle);
+		}
+	}
+
+	// Callers may depend on the obstacle order (as in a plain loop over the vector)
+	std::sort(out.begin() + first, out.end());
+}
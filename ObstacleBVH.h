@@ -0,0 +1,98 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <GL/glut.h>
+
+class Obstacle;
+
+// Collidable obstacle boxes in structure-of-arrays form, for SIMD tests: each BVH leaf
+// owns whole blocks of 8 slots, and unused slots hold boxes no query can reach
+struct PackedBoxes
+{
+	static const size_t blockSize = 8;
+
+	std::vector<GLfloat> centerX, centerZ;	// XZ centers
+	std::vector<GLfloat> halfX, halfZ;		// XZ half sizes
+	std::vector<GLfloat> bottomY, topY;		// Vertical extent
+	std::vector<uint32_t> obstacle;			// Index in the obstacle vector
+
+	size_t size() const { return centerX.size(); }
+};
+
+// Bounding volume hierarchy over the XZ boxes of the collidable obstacles.
+// Static: rebuilt whenever the obstacle set changes.
+class ObstacleBVH
+{
+public:
+	ObstacleBVH() = default;
+	~ObstacleBVH() = default;
+
+	// Rebuild from the collidable obstacles of 'obstacles'
+	void build(const std::vector<Obstacle>& obstacles);
+
+	// Append to 'out' the indices (into the obstacle vector) of the obstacles whose XZ box
+	// overlaps [minX, maxX] x [minZ, maxZ], in ascending order
+	void query(GLfloat minX, GLfloat minZ, GLfloat maxX, GLfloat maxZ, std::vector<uint32_t>& out) const;
+
+	// Call visit(begin, end) with the slots in getPacked() of every leaf whose bounds
+	// overlap [minX, maxX] x [minZ, maxZ]; begin and end are multiples of the block size
+	template <typename Visit>
+	void forEachLeaf(GLfloat minX, GLfloat minZ, GLfloat maxX, GLfloat maxZ, Visit&& visit) const
+	{
+		if (nodes.empty()) return;
+
+		uint32_t stack[2 * maxDepth + 2];
+		int top = 0;
+		stack[top++] = 0;
+		while (top > 0)
+		{
+			const Node& node = nodes[stack[--top]];
+			if (node.maxX < minX || node.minX > maxX || node.maxZ < minZ || node.minZ > maxZ) continue;
+			if (node.left != 0)
+			{
+				stack[top++] = node.right;
+				stack[top++] = node.left;
+				continue;
+			}
+			visit(static_cast<size_t>(node.packedBegin), static_cast<size_t>(node.packedEnd));
+		}
+	}
+
+	// Boxes of the collidable obstacles, grouped by leaf
+	const PackedBoxes& getPacked() const { return packed; }
+
+	// Number of obstacles (collidable or not) in the vector of the last build
+	size_t getSourceCount() const { return sourceCount; }
+
+	size_t size() const { return boxes.size(); }
+	bool empty() const { return boxes.empty(); }
+
+private:
+	// XZ box of an obstacle
+	struct Box
+	{
+		GLfloat minX, minZ, maxX, maxZ;
+		GLfloat centerX, centerZ, halfX, halfZ;
+		GLfloat bottomY, topY;
+		uint32_t obstacle;	// Index in the obstacle vector
+	};
+
+	// Node covering boxes[begin, end)
+	struct Node
+	{
+		GLfloat minX, minZ, maxX, maxZ;	// Bounds of the node's boxes
+		uint32_t begin, end;			// Range in 'boxes'
+		uint32_t left, right;			// Child nodes (0 for a leaf)
+		uint32_t packedBegin, packedEnd;	// Slots in 'packed' (leaves)
+	};
+
+	uint32_t buildNode(uint32_t begin, uint32_t end, int depth);
+
+	static const uint32_t leafSize = 8;	// Maximum boxes in a leaf (one SIMD block)
+	static const int maxDepth = 48;		// Bounds the query stack
+
+	size_t sourceCount = 0;		// Obstacles in the vector of the last build
+	std::vector<Box> boxes;		// Boxes grouped by node
+	std::vector<Node> nodes;	// Nodes, root first
+	PackedBoxes packed;			// Leaf boxes, block-aligned
+};
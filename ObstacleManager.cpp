@@ -4,6 +4,49 @@
 #include "ObstacleManager.h"
 #include "vecFunctions.h"
 
+// Distance field sampling
+static const GLfloat fieldCellSize = 2.0f;	// Node spacing
+static const GLfloat fieldBand = 32.0f;		// Distances are clamped beyond this
+
+// Set the reference floor for obstacle placement (and the distance field's extent)
+void ObstacleManager::setFloor(Floor* floor)
+{
+	worldFloor = floor;
+	hasFloor = (floor != nullptr);
+
+	auto floorSize = hasFloor ? worldFloor->getSize() : Vec3{ 1000.0f, 0.0f, 1000.0f };
+	auto center = hasFloor ? worldFloor->getPosition() : Zero;
+	field.setBounds(center.x - floorSize.x * 0.5f, center.z - floorSize.z * 0.5f,
+		center.x + floorSize.x * 0.5f, center.z + floorSize.z * 0.5f, fieldCellSize, fieldBand);
+	field.update(obstacles, bvh, worldTower);
+}
+
+// Tower baked into the distance field with the obstacles
+void ObstacleManager::setTower(Tower* tower)
+{
+	worldTower = tower;
+	field.invalidateAll();
+	field.update(obstacles, bvh, worldTower);
+}
+
+// Rebuild the hierarchy and rebake the whole distance field
+void ObstacleManager::refresh()
+{
+	bvh.build(obstacles);
+	field.invalidateAll();
+	field.update(obstacles, bvh, worldTower);
+}
+
+// Rebuild the hierarchy and rebake the tiles around a changed obstacle
+void ObstacleManager::obstacleChanged(const Obstacle& obs)
+{
+	bvh.build(obstacles);
+	Vec3 pos = obs.getPosition();
+	Vec3 half = obs.getSize() * 0.5f;
+	field.invalidate(pos.x - half.x, pos.z - half.z, pos.x + half.x, pos.z + half.z);
+	field.update(obstacles, bvh, worldTower);
+}
+
 // Add a single obstacle at a random position on the floor
 void ObstacleManager::addObstacle()
 {
@@ -35,6 +78,7 @@ void ObstacleManager::addObstacle()
 	Vec3 pos = { px, size.y * 0.5f, pz };
 	obstacles.emplace_back(pos, size);
 	obstacles.back().enableCollision();
+	obstacleChanged(obstacles.back());
 }
 
 // Remove the most recently added obstacle
@@ -42,7 +86,9 @@ void ObstacleManager::removeObstacle()
 {
 	if (size() <= static_cast<size_t>(minObstacleCount))
 		return; // Min reached
+	Obstacle removed = obstacles.back();
 	obstacles.pop_back();
+	obstacleChanged(removed);
 }
 
 // Remove all obstacles and recreate them at random positions on the floor
@@ -53,6 +99,8 @@ void ObstacleManager::reset()
 	// Regenerate
 	if (hasFloor)
 		generateRandom(100);
+	else
+		refresh();
 }
 
 // Generate obstacles randomly placed on the floor
@@ -92,4 +140,5 @@ void ObstacleManager::generateRandom(int count, unsigned int seed)
 		obstacles.emplace_back(pos, size);
 		obstacles.back().enableCollision();
 	}
+	refresh();
 }
@@ -4,6 +4,9 @@
 
 #include "Obstacle.h"
 #include "Floor.h"
+#include "ObstacleBVH.h"
+#include "DistanceField.h"
+#include "Tower.h"
 
 class ObstacleManager
 {
@@ -11,8 +14,11 @@ public:
 	ObstacleManager() = default;
 	~ObstacleManager() = default;
 
-	// Set the reference floor for obstacle placement
-	void setFloor(Floor* floor) { worldFloor = floor, hasFloor = (floor != nullptr); }
+	// Set the reference floor for obstacle placement (and the distance field's extent)
+	void setFloor(Floor* floor);
+
+	// Tower baked into the distance field with the obstacles
+	void setTower(Tower* tower);
 
 	// Add a single obstacle
 	void addObstacle();
@@ -26,14 +32,29 @@ public:
 	// Generate obstacles randomly placed on the floor
 	void generateRandom(int count, unsigned int seed = 0);
 
+	// Largest obstacle count accepted by addObstacle and generateRandom
+	void setMaxObstacles(int count) { maxObstacleCount = count; }
+
+	// Rebuild the hierarchy and rebake the distance field; call after editing
+	// getObstacles() directly
+	void refresh();
+
 	std::vector<Obstacle>& getObstacles() { return obstacles; }
+	const ObstacleBVH& getBVH() const { return bvh; }
+	const DistanceField& getDistanceField() const { return field; }
 	size_t size() const { return obstacles.size(); }
 
 private:
 	std::vector<Obstacle> obstacles; // List of obstacles
 	int minObstacleCount = 10;		 // Minimum number of obstacles
 	int maxObstacleCount = 200;		 // Maximum number of obstacles
+	ObstacleBVH bvh;				 // Hierarchy over the obstacles, rebuilt on every change
+	DistanceField field;			 // Distance to the obstacles and the tower
 
 	Floor* worldFloor = nullptr;	 // Reference floor for obstacle placement
 	bool hasFloor = false;			 // Flag indicating if floor is set
+	Tower* worldTower = nullptr;	 // Tower baked into the field
+
+	// Rebuild the hierarchy and rebake the tiles around a changed obstacle
+	void obstacleChanged(const Obstacle& obs);
 };
@@ -0,0 +1,44 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <GL/glut.h>
+
+// Counter-based random numbers (Philox4x32-10): each block of 4 numbers depends only on
+// the key and its counter, so any thread can draw the numbers of any index without
+// sharing or seeding a generator, and the results do not depend on the thread count.
+class Philox
+{
+public:
+	using Block = std::array<uint32_t, 4>;
+
+	explicit Philox(uint64_t seed) : key0(static_cast<uint32_t>(seed)), key1(static_cast<uint32_t>(seed >> 32)) {}
+
+	// Numbers of block 'index' in stream 'stream'
+	Block operator()(uint64_t index, uint32_t stream = 0) const
+	{
+		Block c = { static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32), stream, 0 };
+		uint32_t k0 = key0, k1 = key1;
+		for (int round = 0; round < 10; ++round)
+		{
+			if (round > 0)
+			{
+				k0 += 0x9E3779B9u;
+				k1 += 0xBB67AE85u;
+			}
+			const uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c[0];
+			const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c[2];
+			c = { static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ k0, static_cast<uint32_t>(p1),
+				static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ k1, static_cast<uint32_t>(p0) };
+		}
+		return c;
+	}
+
+	// Uniform in [0, 1) from 24 bits of a number
+	static GLfloat unit(uint32_t bits) { return static_cast<GLfloat>(bits >> 8) * (1.0f / 16777216.0f); }
+
+	// Uniform in [lo, hi)
+	static GLfloat uniform(uint32_t bits, GLfloat lo, GLfloat hi) { return lo + (hi - lo) * unit(bits); }
+
+private:
+	uint32_t key0, key1;
+};
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <cmath>
+
+#include "QuadTree.h"
+
+// Rebuild the tree from n points (x[i], z[i])
+void QuadTree::build(const GLfloat* x, const GLfloat* z, size_t n)
+{
+	px = x;
+	pz = z;
+
+	order.resize(n);
+	for (size_t i = 0; i < n; ++i)
+		order[i] = static_cast<uint32_t>(i);
+
+	nodes.clear();
+	if (n == 0) return;
+
+	// Root: bounding square of the points
+	auto [minX, maxX] = std::minmax_element(x, x + n);
+	auto [minZ, maxZ] = std::minmax_element(z, z + n);
+	GLfloat half = 0.5f * std::max(*maxX - *minX, *maxZ - *minZ);
+	nodes.push_back({ 0.5f * (*minX + *maxX), 0.5f * (*minZ + *maxZ), half, 0, static_cast<uint32_t>(n), 0 });
+	buildNode(0, 0);
+}
+
+// Split a node into four quadrants until it holds at most 'capacity' points
+void QuadTree::buildNode(uint32_t id, int depth)
+{
+	const Node node = nodes[id];
+	if (node.end - node.begin <= capacity || depth >= maxDepth) return;
+
+	// Partition by z, then each half by x: quadrants in (-z -x, -z +x, +z -x, +z +x) order
+	auto first = order.begin() + node.begin;
+	auto last = order.begin() + node.end;
+	auto midZ = std::partition(first, last, [&](uint32_t i) { return pz[i] < node.centerZ; });
+	auto midX0 = std::partition(first, midZ, [&](uint32_t i) { return px[i] < node.centerX; });
+	auto midX1 = std::partition(midZ, last, [&](uint32_t i) { return px[i] < node.centerX; });
+
+	const uint32_t bounds[5] = {
+		node.begin,
+		static_cast<uint32_t>(midX0 - order.begin()),
+		static_cast<uint32_t>(midZ - order.begin()),
+		static_cast<uint32_t>(midX1 - order.begin()),
+		node.end
+	};
+
+	const uint32_t child = static_cast<uint32_t>(nodes.size());
+	nodes[id].child = child;
+	const GLfloat q = 0.5f * node.half;
+	for (int c = 0; c < 4; ++c)
+	{
+		GLfloat cx = node.centerX + ((c & 1) ? q : -q);
+		GLfloat cz = node.centerZ + ((c & 2) ? q : -q);
+		nodes.push_back({ cx, cz, q, bounds[c], bounds[c + 1], 0 });
+	}
+	for (int c = 0; c < 4; ++c)
+		buildNode(child + c, depth + 1);
+}
+
+// Append to 'out' the points closer than 'radius' to (x, z)
+void QuadTree::query(GLfloat x, GLfloat z, GLfloat radius, std::vector<uint32_t>& out) const
+{
+	if (nodes.empty()) return;
+
+	const GLfloat r2 = radius * radius;
+	uint32_t stack[4 * maxDepth + 4];
+	int top = 0;
+	stack[top++] = 0;
+
+	while (top > 0)
+	{
+		const Node& node = nodes[stack[--top]];
+
+		// Distance from the query to the nearest and the farthest point of the square
+		GLfloat ax = std::fabs(x - node.centerX);
+		GLfloat az = std::fabs(z - node.centerZ);
+		GLfloat nx = std::max(0.0f, ax - node.half);
+		GLfloat nz = std::max(0.0f, az - node.half);
+		if (nx * nx + nz * nz >= r2) continue;
+
+		if (node.child != 0)
+		{
+			// Push in reverse so the children are visited in quadrant order
+			for (int c = 3; c >= 0; --c)
+				stack[top++] = node.child + c;
+			continue;
+		}
+
+		GLfloat fx = ax + node.half;
+		GLfloat fz = az + node.half;
+		if (fx * fx + fz * fz < r2)
+		{
+			// Whole leaf inside the radius
+			out.insert(out.end(), order.begin() + node.begin, order.begin() + node.end);
+			continue;
+		}
+
+		for (uint32_t e = node.begin; e < node.end; ++e)
+		{
+			uint32_t i = order[e];
+			GLfloat dx = px[i] - x;
+			GLfloat dz = pz[i] - z;
+			if (dx * dx + dz * dz < r2) out.push_back(i);
+		}
+	}
+}
+
+// Compute the per-node sums of positions and velocities
+void QuadTree::buildAggregates(const GLfloat* velX, const GLfloat* velZ)
+{
+	pvx = velX;
+	pvz = velZ;
+	aggregates.assign(nodes.size(), Aggregate());
+
+	// Children are stored after their parent: sum from the last node back to the root
+	for (size_t id = nodes.size(); id-- > 0;)
+	{
+		const Node& node = nodes[id];
+		Aggregate& a = aggregates[id];
+		if (node.child == 0)
+		{
+			for (uint32_t e = node.begin; e < node.end; ++e)
+			{
+				uint32_t i = order[e];
+				a.sumX += px[i];
+				a.sumZ += pz[i];
+				a.sumVelX += velX[i];
+				a.sumVelZ += velZ[i];
+			}
+		}
+		else
+		{
+			for (uint32_t c = 0; c < 4; ++c)
+			{
+				const Aggregate& child = aggregates[node.child + c];
+				a.sumX += child.sumX;
+				a.sumZ += child.sumZ;
+				a.sumVelX += child.sumVelX;
+				a.sumVelZ += child.sumVelZ;
+			}
+		}
+		a.count = node.end - node.begin;
+	}
+}
+
+// Add the sums b to a
+static void accumulate(QuadTree::Aggregate& a, const QuadTree::Aggregate& b)
+{
+	a.sumX += b.sumX;
+	a.sumZ += b.sumZ;
+	a.sumVelX += b.sumVelX;
+	a.sumVelZ += b.sumVelZ;
+	a.count += b.count;
+}
+
+// Barnes-Hut sums over the points closer than 'radius' to (x, z)
+void QuadTree::gather(GLfloat x, GLfloat z, GLfloat radius, GLfloat openingAngle, Aggregate& out) const
+{
+	if (nodes.empty() || aggregates.size() != nodes.size()) return;
+
+	const GLfloat r2 = radius * radius;
+	const GLfloat theta2 = openingAngle * openingAngle;
+	uint32_t stack[4 * maxDepth + 4];
+	int top = 0;
+	stack[top++] = 0;
+
+	while (top > 0)
+	{
+		const uint32_t id = stack[--top];
+		const Node& node = nodes[id];
+		const Aggregate& a = aggregates[id];
+		if (a.count == 0) continue;
+
+		GLfloat ax = std::fabs(x - node.centerX);
+		GLfloat az = std::fabs(z - node.centerZ);
+		GLfloat nx = std::max(0.0f, ax - node.half);
+		GLfloat nz = std::max(0.0f, az - node.half);
+		if (nx * nx + nz * nz >= r2) continue;
+
+		// A node holding the query point is always opened, so the point never counts itself
+		const bool outside = ax > node.half || az > node.half;
+		if (outside)
+		{
+			// Whole node inside the radius
+			GLfloat fx = ax + node.half;
+			GLfloat fz = az + node.half;
+			if (fx * fx + fz * fz < r2)
+			{
+				accumulate(out, a);
+				continue;
+			}
+
+			// Far enough: one pseudo-point at the center of mass
+			GLfloat dx = a.sumX / a.count - x;
+			GLfloat dz = a.sumZ / a.count - z;
+			GLfloat d2 = dx * dx + dz * dz;
+			GLfloat side = 2.0f * node.half;
+			if (side * side < theta2 * d2)
+			{
+				if (d2 < r2) accumulate(out, a);
+				continue;
+			}
+		}
+
+		if (node.child != 0)
+		{
+			for (int c = 3; c >= 0; --c)
+				stack[top++] = node.child + c;
+			continue;
+		}
+
+		// Leaf: exact test of every point
+		for (uint32_t e = node.begin; e < node.end; ++e)
+		{
+			uint32_t i = order[e];
+			GLfloat dx = px[i] - x;
+			GLfloat dz = pz[i] - z;
+			GLfloat d2 = dx * dx + dz * dz;
+			if (d2 <= 0.0f || d2 >= r2) continue;
+			out.sumX += px[i];
+			out.sumZ += pz[i];
+			out.sumVelX += pvx[i];
+			out.sumVelZ += pvz[i];
+			++out.count;
+		}
+	}
+}
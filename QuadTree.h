@@ -0,0 +1,75 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <GL/glut.h>
+
+// Adaptive quadtree over the XZ plane used for boid radius queries.
+// Nodes split until they hold at most 'capacity' points, so dense clusters get small
+// cells and sparse regions large ones, and a query tests about the same number of
+// points whatever the local density.
+class QuadTree
+{
+public:
+	// Sums over the points of a node (or of a Barnes-Hut query)
+	struct Aggregate
+	{
+		GLfloat sumX = 0.0f, sumZ = 0.0f;		// Sum of positions
+		GLfloat sumVelX = 0.0f, sumVelZ = 0.0f;	// Sum of velocities
+		uint32_t count = 0;						// Number of points
+	};
+
+	QuadTree() = default;
+	~QuadTree() = default;
+
+	// Maximum points in a leaf
+	void setCapacity(uint32_t c) { capacity = c < 1 ? 1 : c; }
+	uint32_t getCapacity() const { return capacity; }
+
+	// Rebuild the tree from n points (x[i], z[i]); the arrays must outlive the queries
+	void build(const GLfloat* x, const GLfloat* z, size_t n);
+
+	// Append to 'out' the points closer than 'radius' to (x, z).
+	// The order only depends on the points, not on the thread running the query.
+	void query(GLfloat x, GLfloat z, GLfloat radius, std::vector<uint32_t>& out) const;
+
+	// Compute the per-node sums of positions and velocities (after build);
+	// the arrays must outlive the queries
+	void buildAggregates(const GLfloat* velX, const GLfloat* velZ);
+
+	// Barnes-Hut sums over the points closer than 'radius' to (x, z), excluding points
+	// at (x, z) itself. Nodes seen under an angle (side / distance to their center of
+	// mass) below 'openingAngle' count as one pseudo-point at their center of mass.
+	// Requires buildAggregates.
+	void gather(GLfloat x, GLfloat z, GLfloat radius, GLfloat openingAngle, Aggregate& out) const;
+
+	size_t getNodeCount() const { return nodes.size(); }
+
+	// Bytes held by the tree arrays
+	size_t getMemoryUsage() const
+	{
+		return order.capacity() * sizeof(uint32_t) + nodes.capacity() * sizeof(Node) + aggregates.capacity() * sizeof(Aggregate);
+	}
+
+private:
+	// Square node covering order[begin, end)
+	struct Node
+	{
+		GLfloat centerX, centerZ;	// Center of the square
+		GLfloat half;				// Half of the side
+		uint32_t begin, end;		// Range of points in 'order'
+		uint32_t child;				// First of the four children (0 for a leaf)
+	};
+
+	void buildNode(uint32_t id, int depth);
+
+	static const int maxDepth = 24;	// Stops splitting coincident points
+
+	uint32_t capacity = 32;			// Maximum points in a leaf
+	const GLfloat* px = nullptr;	// Point coordinates
+	const GLfloat* pz = nullptr;
+	const GLfloat* pvx = nullptr;	// Point velocities (Barnes-Hut)
+	const GLfloat* pvz = nullptr;
+	std::vector<uint32_t> order;	// Point indices grouped by node
+	std::vector<Node> nodes;		// Nodes, root first
+	std::vector<Aggregate> aggregates;	// Sums of each node (Barnes-Hut)
+};
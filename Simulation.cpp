@@ -0,0 +1,105 @@
+#include <algorithm>
+
+#include "Simulation.h"
+
+// Fixed step rate and cap on catch-up steps after a stall
+void Simulation::setRate(GLfloat stepsPerSecond, int maxCatchUpSteps)
+{
+	stepLength = 1.0f / std::max(1.0f, stepsPerSecond);
+	maxCatchUp = std::max(1, maxCatchUpSteps);
+}
+
+// Start the simulation thread
+void Simulation::start()
+{
+	if (running) return;
+
+	// Publish the initial state so the renderer has something to draw
+	capture(snapshots.getWriteBuffer());
+	snapshots.publish();
+
+	running = true;
+	thread = std::thread(&Simulation::run, this);
+}
+
+// Stop the simulation thread
+void Simulation::stop()
+{
+	running = false;
+	if (thread.joinable()) thread.join();
+}
+
+// Renderer: newest completed step
+SimSnapshot& Simulation::acquireSnapshot()
+{
+	snapshots.update();
+	return snapshots.getReadBuffer();
+}
+
+// Renderer: how far (0..1) the wall clock is past the snapshot's step
+GLfloat Simulation::getInterpolationAlpha(const SimSnapshot& snapshot) const
+{
+	auto elapsed = std::chrono::duration<GLfloat>(std::chrono::steady_clock::now() - snapshot.time).count();
+	return std::clamp(elapsed / stepLength, 0.0f, 1.0f);
+}
+
+// Simulation loop: one fixed step per period, catching up after short stalls
+void Simulation::run()
+{
+	using Clock = std::chrono::steady_clock;
+	const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(stepLength));
+	auto nextTime = Clock::now();
+
+	while (running)
+	{
+		auto now = Clock::now();
+		if (now < nextTime)
+		{
+			std::this_thread::sleep_until(nextTime);
+			continue;
+		}
+
+		int steps = 0;
+		while (now >= nextTime && steps < maxCatchUp)
+		{
+			if (!paused) step();
+			nextTime += period;
+			++steps;
+		}
+
+		// Too far behind: drop the backlog instead of spiralling
+		if (now >= nextTime) nextTime = now + period;
+	}
+}
+
+// Advance the leader and the flock by one step and publish the result
+void Simulation::step()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (leaderBoid) leaderBoid->update(stepLength);
+		if (simFlock && hasCamera) simFlock->setCameraPosition(Vec3(cameraX, cameraY, cameraZ));
+		if (simFlock) simFlock->update(stepLength);
+		++stepIndex;
+		capture(snapshots.getWriteBuffer());
+	}
+	snapshots.publish();
+}
+
+// Copy the simulated objects into a snapshot (reuses the snapshot's buffers)
+void Simulation::capture(SimSnapshot& snapshot)
+{
+	if (simFlock)
+	{
+		snapshot.flock = simFlock->getState();
+		snapshot.previousFlock = simFlock->getPreviousState();
+		snapshot.flockCenter = simFlock->getAvgPosition();
+	}
+	if (leaderBoid)
+	{
+		snapshot.leader = *leaderBoid;
+		if (!simFlock) snapshot.flockCenter = leaderBoid->getPosition();
+	}
+	snapshot.time = std::chrono::steady_clock::now();
+	snapshot.stepIndex = stepIndex;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "Flock.h"
+#include "ControlledBoid.h"
+#include "FlockState.h"
+#include "TripleBuffer.h"
+
+// Completed simulation step published to the renderer
+struct SimSnapshot
+{
+	FlockState flock;			// Flock state after the step
+	FlockState previousFlock;	// Flock state before the step (for interpolation)
+	ControlledBoid leader;		// Copy of the leader after the step
+	Vec3 flockCenter;			// Average flock position
+	std::chrono::steady_clock::time_point time;	// When the step was published
+	uint64_t stepIndex = 0;		// Number of steps simulated so far
+};
+
+// Runs the leader and flock simulation at a fixed rate on its own thread.
+// Completed steps are published through a lock-free triple buffer, so the
+// renderer never waits for the simulation.
+class Simulation
+{
+public:
+	Simulation() = default;
+	~Simulation() { stop(); }
+
+	// Objects to simulate (set before start)
+	void setWorld(ControlledBoid* leader, Flock* flock) { leaderBoid = leader, simFlock = flock; }
+
+	// Fixed step rate and cap on catch-up steps after a stall (set before start)
+	void setRate(GLfloat stepsPerSecond, int maxCatchUpSteps);
+	GLfloat getStepLength() const { return stepLength; }
+
+	// Start and stop the simulation thread
+	void start();
+	void stop();
+
+	// Pause and resume stepping
+	void setPaused(bool p) { paused = p; }
+	bool isPaused() const { return paused; }
+
+	// Held by the simulation thread while it steps: lock it before changing
+	// the leader, the flock or the world obstacles from another thread
+	std::mutex& getMutex() { return mutex; }
+
+	// Renderer: position of the camera, passed to the flock as a level of detail focus
+	void setCameraPosition(const Vec3& p) { cameraX = p.x; cameraY = p.y; cameraZ = p.z; hasCamera = true; }
+
+	// Renderer: newest completed step and how far (0..1) the wall clock is past it
+	SimSnapshot& acquireSnapshot();
+	GLfloat getInterpolationAlpha(const SimSnapshot& snapshot) const;
+
+private:
+	void run();
+	void step();
+	void capture(SimSnapshot& snapshot);
+
+	ControlledBoid* leaderBoid = nullptr;	// Simulated leader
+	Flock* simFlock = nullptr;				// Simulated flock
+
+	GLfloat stepLength = 1.0f / 60.0f;	// Fixed step in seconds
+	int maxCatchUp = 5;					// Maximum steps run back to back
+	uint64_t stepIndex = 0;				// Steps simulated so far
+
+	TripleBuffer<SimSnapshot> snapshots;	// Completed steps
+	std::thread thread;						// Simulation thread
+	std::mutex mutex;						// Guards the simulated objects
+	std::atomic<bool> running{ false };
+	std::atomic<bool> paused{ false };
+
+	// Camera position from the renderer (components may be a frame apart)
+	std::atomic<GLfloat> cameraX{ 0.0f }, cameraY{ 0.0f }, cameraZ{ 0.0f };
+	std::atomic<bool> hasCamera{ false };
+};
@@ -0,0 +1,82 @@
+#include <utility>
+
+#include "SlotMap.h"
+
+// Handle of a new item in slot size()
+SlotHandle SlotMap::insert()
+{
+	uint32_t entry;
+	if (freeHead != noEntry)
+	{
+		entry = freeHead;
+		freeHead = entries[entry].slot;
+	}
+	else
+	{
+		entry = static_cast<uint32_t>(entries.size());
+		entries.push_back({ 0, 0 });
+	}
+
+	entries[entry].slot = static_cast<uint32_t>(slotEntry.size());
+	slotEntry.push_back(entry);
+	return (static_cast<uint64_t>(entries[entry].generation) << 32) | entry;
+}
+
+// Erase the item of a handle; the last item moves into its slot
+bool SlotMap::erase(SlotHandle handle, uint32_t& slot)
+{
+	int found = find(handle);
+	if (found < 0) return false;
+
+	const uint32_t entry = static_cast<uint32_t>(handle);
+	slot = static_cast<uint32_t>(found);
+
+	// The last item takes the freed slot
+	const uint32_t moved = slotEntry.back();
+	slotEntry[slot] = moved;
+	entries[moved].slot = slot;
+	slotEntry.pop_back();
+
+	// Free the entry under a new generation
+	entries[entry].generation++;
+	entries[entry].slot = freeHead;
+	freeHead = entry;
+	return true;
+}
+
+// Erase every item
+void SlotMap::clear()
+{
+	for (uint32_t entry : slotEntry)
+	{
+		entries[entry].generation++;
+		entries[entry].slot = freeHead;
+		freeHead = entry;
+	}
+	slotEntry.clear();
+}
+
+// Slot of a handle, or -1 if its item was erased
+int SlotMap::find(SlotHandle handle) const
+{
+	const uint32_t entry = static_cast<uint32_t>(handle);
+	const uint32_t generation = static_cast<uint32_t>(handle >> 32);
+	if (entry >= entries.size() || entries[entry].generation != generation) return -1;
+
+	// Live entries point to a slot that points back to them
+	const uint32_t slot = entries[entry].slot;
+	if (slot >= slotEntry.size() || slotEntry[slot] != entry) return -1;
+	return static_cast<int>(slot);
+}
+
+// Slot i now holds the item of slot order[i]
+void SlotMap::permute(const std::vector<uint32_t>& order)
+{
+	scratch.resize(order.size());
+	for (size_t i = 0; i < order.size(); ++i)
+	{
+		scratch[i] = slotEntry[order[i]];
+		entries[scratch[i]].slot = static_cast<uint32_t>(i);
+	}
+	std::swap(slotEntry, scratch);
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Generational handle: entry index in the low half, generation in the high half
+using SlotHandle = uint64_t;
+const SlotHandle invalidSlot = UINT64_MAX;
+
+// Stable handles to items stored densely in external arrays (slots 0 .. size - 1).
+// Each live item owns an entry that records its slot; erasing moves the last item
+// into the freed slot, so the arrays stay dense and erase is O(1). Freed entries are
+// reused with a new generation, so handles to erased items stop resolving.
+// The map only tracks slots: the owner moves its own data as told.
+class SlotMap
+{
+public:
+	SlotMap() = default;
+	~SlotMap() = default;
+
+	// Handle of a new item in slot size()
+	SlotHandle insert();
+
+	// Erase the item of 'handle': the owner must move its last item into 'slot'.
+	// False if the handle is stale.
+	bool erase(SlotHandle handle, uint32_t& slot);
+
+	// Erase every item; existing handles become stale
+	void clear();
+
+	// Slot of a handle, or -1 if its item was erased
+	int find(SlotHandle handle) const;
+
+	// Handle of the item in a slot
+	SlotHandle getHandle(size_t slot) const { return (static_cast<uint64_t>(entries[slotEntry[slot]].generation) << 32) | slotEntry[slot]; }
+
+	// Entry index of the item in a slot: stable, small, and reused after an erase
+	uint32_t getEntry(size_t slot) const { return slotEntry[slot]; }
+
+	// The items were permuted: slot i now holds the item of slot order[i]
+	void permute(const std::vector<uint32_t>& order);
+
+	void reserve(size_t n) { entries.reserve(n); slotEntry.reserve(n); }
+	size_t size() const { return slotEntry.size(); }
+
+	// Bytes held by the map
+	size_t getMemoryUsage() const { return entries.capacity() * sizeof(Entry) + (slotEntry.capacity() + scratch.capacity()) * sizeof(uint32_t); }
+
+private:
+	static const uint32_t noEntry = UINT32_MAX;
+
+	// Slot of a live item, or the next free entry
+	struct Entry
+	{
+		uint32_t slot;			// Slot (live) or next free entry (free)
+		uint32_t generation;	// Incremented when the entry is freed
+	};
+
+	std::vector<Entry> entries;			// All entries, live or free
+	std::vector<uint32_t> slotEntry;	// Entry of each slot
+	std::vector<uint32_t> scratch;		// Permutation buffer
+	uint32_t freeHead = noEntry;		// First free entry
+};
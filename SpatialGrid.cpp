@@ -0,0 +1,90 @@
+#include <cmath>
+#include <algorithm>
+
+#include "SpatialGrid.h"
+
+// Rebuild the grid from n points (x[i], z[i]) with the given cell size
+void SpatialGrid::build(const GLfloat* x, const GLfloat* z, size_t n, GLfloat size)
+{
+	cellSize = std::max(size, 1e-3f);
+	invCellSize = 1.0f / cellSize;
+
+	// Bucket count: power of two, about twice the number of points
+	uint32_t buckets = 16;
+	while (buckets < n * 2) buckets <<= 1;
+	bucketMask = buckets - 1;
+
+	bucketStart.assign(buckets + 1, 0);
+	entries.resize(n);
+	pointBucket.resize(n);
+
+	// Count points per bucket
+	for (size_t i = 0; i < n; ++i)
+	{
+		uint32_t b = bucketOf(cellCoord(x[i]), cellCoord(z[i]));
+		pointBucket[i] = b;
+		++bucketStart[b + 1];
+	}
+	// Prefix sum into start offsets
+	for (uint32_t b = 0; b < buckets; ++b)
+		bucketStart[b + 1] += bucketStart[b];
+
+	// Scatter in index order so each bucket stays sorted by index
+	bucketFill.assign(bucketStart.begin(), bucketStart.end() - 1);
+	for (size_t i = 0; i < n; ++i)
+		entries[bucketFill[pointBucket[i]]++] = static_cast<uint32_t>(i);
+}
+
+// Append to 'out' the indices of all points in the 3x3 block of cells around (x, z)
+void SpatialGrid::query(GLfloat x, GLfloat z, std::vector<uint32_t>& out) const
+{
+	if (entries.empty()) return;
+
+	const int32_t cx = cellCoord(x);
+	const int32_t cz = cellCoord(z);
+
+	// Distinct cells may hash to the same bucket: visit each bucket once
+	uint32_t visited[9];
+	int visitedCount = 0;
+
+	for (int32_t dz = -1; dz <= 1; ++dz)
+	{
+		for (int32_t dx = -1; dx <= 1; ++dx)
+		{
+			uint32_t b = bucketOf(cx + dx, cz + dz);
+			bool seen = false;
+			for (int k = 0; k < visitedCount; ++k)
+				if (visited[k] == b) { seen = true; break; }
+			if (seen) continue;
+			visited[visitedCount++] = b;
+
+			for (uint32_t e = bucketStart[b]; e < bucketStart[b + 1]; ++e)
+				out.push_back(entries[e]);
+		}
+	}
+}
+
+// Mean number of points in the bucket of a point
+GLfloat SpatialGrid::getCrowding() const
+{
+	if (entries.empty()) return 0.0f;
+	double sum = 0.0;
+	for (size_t b = 0; b + 1 < bucketStart.size(); ++b)
+	{
+		double count = bucketStart[b + 1] - bucketStart[b];
+		sum += count * count;
+	}
+	return static_cast<GLfloat>(sum / entries.size());
+}
+
+// Hash a cell coordinate into a bucket index
+uint32_t SpatialGrid::bucketOf(int32_t cx, int32_t cz) const
+{
+	uint32_t h = static_cast<uint32_t>(cx) * 73856093u ^ static_cast<uint32_t>(cz) * 19349663u;
+	return h & bucketMask;
+}
+
+int32_t SpatialGrid::cellCoord(GLfloat v) const
+{
+	return static_cast<int32_t>(std::floor(v * invCellSize));
+}
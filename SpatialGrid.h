@@ -0,0 +1,45 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <GL/glut.h>
+
+// Uniform spatial hash grid over the XZ plane used for boid neighbor queries
+class SpatialGrid
+{
+public:
+	SpatialGrid() = default;
+	~SpatialGrid() = default;
+
+	// Rebuild the grid from n points (x[i], z[i]) with the given cell size
+	void build(const GLfloat* x, const GLfloat* z, size_t n, GLfloat cellSize);
+
+	// Append to 'out' the indices of all points in the 3x3 block of cells around (x, z).
+	// The order is stable: buckets in a fixed visiting order, indices ascending within a bucket.
+	void query(GLfloat x, GLfloat z, std::vector<uint32_t>& out) const;
+
+	// Mean number of points in the bucket of a point (1 when no two points share one)
+	GLfloat getCrowding() const;
+
+	GLfloat getCellSize() const { return cellSize; }
+	size_t getBucketCount() const { return bucketMask + 1; }
+
+	// Bytes held by the grid arrays
+	size_t getMemoryUsage() const
+	{
+		return (bucketStart.capacity() + entries.capacity() + pointBucket.capacity() + bucketFill.capacity()) * sizeof(uint32_t);
+	}
+
+private:
+	// Hash a cell coordinate into a bucket index
+	uint32_t bucketOf(int32_t cx, int32_t cz) const;
+	int32_t cellCoord(GLfloat v) const;
+
+	GLfloat cellSize = 1.0f;		// Size of a grid cell
+	GLfloat invCellSize = 1.0f;		// Inverse of the cell size
+	uint32_t bucketMask = 0;		// Bucket count - 1 (power of two)
+
+	std::vector<uint32_t> bucketStart;	// Start offset of each bucket in 'entries'
+	std::vector<uint32_t> entries;		// Point indices sorted by bucket
+	std::vector<uint32_t> pointBucket;	// Bucket of each point (scratch)
+	std::vector<uint32_t> bucketFill;	// Fill cursor of each bucket (scratch)
+};
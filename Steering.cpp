@@ -0,0 +1,602 @@
+#include <cmath>
+#include <algorithm>
+#include <bit>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#endif
+
+#include "Steering.h"
+#include "World.h"
+#include "Obstacle.h"
+#include "ObstacleBVH.h"
+#include "DistanceField.h"
+#include "Tower.h"
+#include "ControlledBoid.h"
+
+// Obstacle avoidance tuning
+static const GLfloat obstacleWeight = 10.0f;
+static const GLfloat safetyPadding = 1.0f;
+
+// Neighbor sums gathered by the flocking pass
+struct NeighborSums
+{
+	GLfloat centerX = 0.0f, centerZ = 0.0f;	// Sum of neighbor positions
+	GLfloat velX = 0.0f, velZ = 0.0f;		// Sum of neighbor velocities
+	GLfloat pushX = 0.0f, pushZ = 0.0f;		// Sum of inverse distance pushes
+	int neighCount = 0;						// Neighbors inside neighRadius
+	int sepCount = 0;						// Neighbors inside separationRadius
+};
+
+// Scalar pass over the neighbor candidates
+static void accumulateScalar(const FlockState& state, GLfloat x, GLfloat z,
+	const uint32_t* neighbors, size_t count, GLfloat neigh2, GLfloat sep2, NeighborSums& sums)
+{
+	const GLfloat* posX = state.posX.data();
+	const GLfloat* posZ = state.posZ.data();
+	const GLfloat* velX = state.velX.data();
+	const GLfloat* velZ = state.velZ.data();
+
+	for (size_t k = 0; k < count; ++k)
+	{
+		const uint32_t j = neighbors[k];
+
+		// distance in XZ plane (self and coincident boids have d2 == 0 and are skipped)
+		GLfloat dx = x - posX[j];
+		GLfloat dz = z - posZ[j];
+		GLfloat d2 = dx * dx + dz * dz;
+		if (d2 <= 0.0f) continue;
+
+		if (d2 < neigh2)
+		{
+			sums.centerX += posX[j];
+			sums.centerZ += posZ[j];
+			sums.velX += velX[j];
+			sums.velZ += velZ[j];
+			++sums.neighCount;
+		}
+		if (d2 < sep2)
+		{
+			// Vector pointing away from neighbor, weighted by inverse distance
+			sums.pushX += dx / d2;
+			sums.pushZ += dz / d2;
+			++sums.sepCount;
+		}
+	}
+}
+
+#if defined(__AVX2__)
+
+// Horizontal sum of the 8 lanes in a fixed order
+static inline GLfloat horizontalSum(__m256 v)
+{
+	__m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+	s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+	s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+	return _mm_cvtss_f32(s);
+}
+
+// AVX2 pass: 8 neighbors per iteration, gathered straight from the state arrays
+static void accumulateSimd(const FlockState& state, uint32_t self, GLfloat x, GLfloat z,
+	const uint32_t* neighbors, size_t count, GLfloat neigh2, GLfloat sep2, NeighborSums& sums)
+{
+	const GLfloat* posX = state.posX.data();
+	const GLfloat* posZ = state.posZ.data();
+	const GLfloat* velX = state.velX.data();
+	const GLfloat* velZ = state.velZ.data();
+
+	const __m256 px = _mm256_set1_ps(x), pz = _mm256_set1_ps(z);
+	const __m256 vNeigh2 = _mm256_set1_ps(neigh2), vSep2 = _mm256_set1_ps(sep2);
+	const __m256 zero = _mm256_setzero_ps();
+
+	__m256 centerX = zero, centerZ = zero, sumVelX = zero, sumVelZ = zero, pushX = zero, pushZ = zero;
+	int neighCount = 0, sepCount = 0;
+
+	for (size_t k = 0; k < count; k += 8)
+	{
+		// Pad the last block with self, which has d2 == 0 and is masked out
+		__m256i idx;
+		if (k + 8 <= count)
+			idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(neighbors + k));
+		else
+		{
+			alignas(32) uint32_t tail[8];
+			for (size_t t = 0; t < 8; ++t)
+				tail[t] = (k + t < count) ? neighbors[k + t] : self;
+			idx = _mm256_load_si256(reinterpret_cast<const __m256i*>(tail));
+		}
+
+		const __m256 ox = _mm256_i32gather_ps(posX, idx, 4);
+		const __m256 oz = _mm256_i32gather_ps(posZ, idx, 4);
+		const __m256 dx = _mm256_sub_ps(px, ox);
+		const __m256 dz = _mm256_sub_ps(pz, oz);
+		const __m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dz, dz));
+
+		// Radius tests
+		const __m256 valid = _mm256_cmp_ps(d2, zero, _CMP_GT_OQ);
+		const __m256 inNeigh = _mm256_and_ps(valid, _mm256_cmp_ps(d2, vNeigh2, _CMP_LT_OQ));
+		const __m256 inSep = _mm256_and_ps(valid, _mm256_cmp_ps(d2, vSep2, _CMP_LT_OQ));
+		const int neighMask = _mm256_movemask_ps(inNeigh);
+		const int sepMask = _mm256_movemask_ps(inSep);
+
+		if (neighMask)
+		{
+			const __m256 ovx = _mm256_mask_i32gather_ps(zero, velX, idx, inNeigh, 4);
+			const __m256 ovz = _mm256_mask_i32gather_ps(zero, velZ, idx, inNeigh, 4);
+			centerX = _mm256_add_ps(centerX, _mm256_and_ps(inNeigh, ox));
+			centerZ = _mm256_add_ps(centerZ, _mm256_and_ps(inNeigh, oz));
+			sumVelX = _mm256_add_ps(sumVelX, ovx);
+			sumVelZ = _mm256_add_ps(sumVelZ, ovz);
+			neighCount += std::popcount(static_cast<unsigned>(neighMask));
+		}
+		if (sepMask)
+		{
+			// Inverse square weight; lanes with d2 == 0 are masked before use
+			const __m256 safeD2 = _mm256_blendv_ps(_mm256_set1_ps(1.0f), d2, inSep);
+			pushX = _mm256_add_ps(pushX, _mm256_and_ps(inSep, _mm256_div_ps(dx, safeD2)));
+			pushZ = _mm256_add_ps(pushZ, _mm256_and_ps(inSep, _mm256_div_ps(dz, safeD2)));
+			sepCount += std::popcount(static_cast<unsigned>(sepMask));
+		}
+	}
+
+	sums.centerX = horizontalSum(centerX);
+	sums.centerZ = horizontalSum(centerZ);
+	sums.velX = horizontalSum(sumVelX);
+	sums.velZ = horizontalSum(sumVelZ);
+	sums.pushX = horizontalSum(pushX);
+	sums.pushZ = horizontalSum(pushZ);
+	sums.neighCount = neighCount;
+	sums.sepCount = sepCount;
+}
+
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
+// Horizontal sum of the 4 lanes in a fixed order
+static inline GLfloat horizontalSum(__m128 v)
+{
+	__m128 s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+	s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+	return _mm_cvtss_f32(s);
+}
+
+// SSE2 pass: 4 neighbors per iteration
+static void accumulateSimd(const FlockState& state, uint32_t self, GLfloat x, GLfloat z,
+	const uint32_t* neighbors, size_t count, GLfloat neigh2, GLfloat sep2, NeighborSums& sums)
+{
+	const GLfloat* posX = state.posX.data();
+	const GLfloat* posZ = state.posZ.data();
+	const GLfloat* velX = state.velX.data();
+	const GLfloat* velZ = state.velZ.data();
+
+	const __m128 px = _mm_set1_ps(x), pz = _mm_set1_ps(z);
+	const __m128 vNeigh2 = _mm_set1_ps(neigh2), vSep2 = _mm_set1_ps(sep2);
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+
+	__m128 centerX = zero, centerZ = zero, sumVelX = zero, sumVelZ = zero, pushX = zero, pushZ = zero;
+	int neighCount = 0, sepCount = 0;
+
+	for (size_t k = 0; k < count; k += 4)
+	{
+		// Pad the last block with self, which has d2 == 0 and is masked out
+		uint32_t j[4];
+		for (size_t t = 0; t < 4; ++t)
+			j[t] = (k + t < count) ? neighbors[k + t] : self;
+
+		const __m128 ox = _mm_setr_ps(posX[j[0]], posX[j[1]], posX[j[2]], posX[j[3]]);
+		const __m128 oz = _mm_setr_ps(posZ[j[0]], posZ[j[1]], posZ[j[2]], posZ[j[3]]);
+		const __m128 dx = _mm_sub_ps(px, ox);
+		const __m128 dz = _mm_sub_ps(pz, oz);
+		const __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz));
+
+		// Radius tests
+		const __m128 valid = _mm_cmpgt_ps(d2, zero);
+		const __m128 inNeigh = _mm_and_ps(valid, _mm_cmplt_ps(d2, vNeigh2));
+		const __m128 inSep = _mm_and_ps(valid, _mm_cmplt_ps(d2, vSep2));
+		const int neighMask = _mm_movemask_ps(inNeigh);
+		const int sepMask = _mm_movemask_ps(inSep);
+
+		if (neighMask)
+		{
+			const __m128 ovx = _mm_setr_ps(velX[j[0]], velX[j[1]], velX[j[2]], velX[j[3]]);
+			const __m128 ovz = _mm_setr_ps(velZ[j[0]], velZ[j[1]], velZ[j[2]], velZ[j[3]]);
+			centerX = _mm_add_ps(centerX, _mm_and_ps(inNeigh, ox));
+			centerZ = _mm_add_ps(centerZ, _mm_and_ps(inNeigh, oz));
+			sumVelX = _mm_add_ps(sumVelX, _mm_and_ps(inNeigh, ovx));
+			sumVelZ = _mm_add_ps(sumVelZ, _mm_and_ps(inNeigh, ovz));
+			neighCount += std::popcount(static_cast<unsigned>(neighMask));
+		}
+		if (sepMask)
+		{
+			// Inverse square weight; lanes with d2 == 0 are masked before use
+			const __m128 safeD2 = _mm_or_ps(_mm_and_ps(inSep, d2), _mm_andnot_ps(inSep, one));
+			pushX = _mm_add_ps(pushX, _mm_and_ps(inSep, _mm_div_ps(dx, safeD2)));
+			pushZ = _mm_add_ps(pushZ, _mm_and_ps(inSep, _mm_div_ps(dz, safeD2)));
+			sepCount += std::popcount(static_cast<unsigned>(sepMask));
+		}
+	}
+
+	sums.centerX = horizontalSum(centerX);
+	sums.centerZ = horizontalSum(centerZ);
+	sums.velX = horizontalSum(sumVelX);
+	sums.velZ = horizontalSum(sumVelZ);
+	sums.pushX = horizontalSum(pushX);
+	sums.pushZ = horizontalSum(pushZ);
+	sums.neighCount = neighCount;
+	sums.sepCount = sepCount;
+}
+
+#else
+
+// No SIMD instruction set available: use the scalar pass
+static void accumulateSimd(const FlockState& state, uint32_t self, GLfloat x, GLfloat z,
+	const uint32_t* neighbors, size_t count, GLfloat neigh2, GLfloat sep2, NeighborSums& sums)
+{
+	accumulateScalar(state, x, z, neighbors, count, neigh2, sep2, sums);
+}
+
+#endif
+
+// Flocking behaviors in a single pass over the neighbors
+void steerNeighbors(const FlockState& state, uint32_t self,
+	const uint32_t* neighbors, size_t count, const BoidParams& params,
+	Vec3& cohesion, Vec3& separation, Vec3& alignment, bool useSimd)
+{
+	const Vec3 pos = state.getPosition(self);
+	const Vec3 vel = state.getVelocity(self);
+	const GLfloat neigh2 = params.neighRadius * params.neighRadius;
+	const GLfloat sep2 = params.separationRadius * params.separationRadius;
+
+	NeighborSums sums;
+	if (useSimd)
+		accumulateSimd(state, self, pos.x, pos.z, neighbors, count, neigh2, sep2, sums);
+	else
+		accumulateScalar(state, pos.x, pos.z, neighbors, count, neigh2, sep2, sums);
+
+	separation = Zero;
+	steerAverages(pos, vel, sums.centerX, sums.centerZ, sums.velX, sums.velZ, sums.neighCount, params, cohesion, alignment);
+
+	if (sums.sepCount > 0)
+	{
+		// Separation: average push direction at full speed
+		Vec3 push = { sums.pushX, 0.0f, sums.pushZ };
+		push.x /= static_cast<GLfloat>(sums.sepCount);
+		push.z /= static_cast<GLfloat>(sums.sepCount);
+		normalize(push);
+		push.x *= params.maxSpeed;
+		push.z *= params.maxSpeed;
+		separation = push - vel;
+		separation.y = 0.0f;
+		limit(separation, params.maxForce);
+	}
+}
+
+// Cohesion and alignment from the sums of 'count' neighbor positions and velocities
+void steerAverages(const Vec3& pos, const Vec3& vel, GLfloat sumX, GLfloat sumZ,
+	GLfloat sumVelX, GLfloat sumVelZ, int count, const BoidParams& params, Vec3& cohesion, Vec3& alignment)
+{
+	cohesion = alignment = Zero;
+
+	if (count > 0)
+	{
+		// Cohesion: desired = average position - position (only XZ)
+		Vec3 center = { sumX / count, 0.0f, sumZ / count };
+		Vec3 desired = { center.x - pos.x, 0.0f, center.z - pos.z };
+		normalize(desired);
+		desired *= params.maxSpeed;
+		cohesion = { desired.x - vel.x, 0.0f, desired.z - vel.z };
+		limit(cohesion, params.maxForce);
+
+		// Alignment: desired = average velocity
+		Vec3 avgVelocity = { sumVelX, 0.0f, sumVelZ };
+		avgVelocity /= static_cast<GLfloat>(count);
+		normalize(avgVelocity);
+		avgVelocity *= params.maxSpeed;
+		alignment = avgVelocity - vel;
+		limit(alignment, params.maxForce);
+		alignment.y = 0.0f;
+	}
+}
+
+// Approximate flocking from summed-area tables
+void steerSummedArea(const SummedAreaTable& table, const Vec3& pos, const Vec3& vel,
+	const BoidParams& params, Vec3& cohesion, Vec3& separation, Vec3& alignment)
+{
+	// The boxes always hold the boid itself: take it out of the sums
+	SummedAreaTable::Sums s = table.query(pos.x, pos.z, params.neighRadius);
+	int count = static_cast<int>(s.count) - 1;
+	steerAverages(pos, vel, static_cast<GLfloat>(s.sumX - pos.x), static_cast<GLfloat>(s.sumZ - pos.z),
+		static_cast<GLfloat>(s.sumVelX - vel.x), static_cast<GLfloat>(s.sumVelZ - vel.z), count, params, cohesion, alignment);
+
+	separation = Zero;
+	s = table.query(pos.x, pos.z, params.separationRadius);
+	count = static_cast<int>(s.count) - 1;
+	if (count > 0)
+	{
+		// Separation: away from the mean position of the close boids, at full speed
+		Vec3 push = { pos.x - static_cast<GLfloat>((s.sumX - pos.x) / count), 0.0f,
+			pos.z - static_cast<GLfloat>((s.sumZ - pos.z) / count) };
+		if (length(push) > 1e-6f)
+		{
+			normalize(push);
+			push.x *= params.maxSpeed;
+			push.z *= params.maxSpeed;
+			separation = push - vel;
+			separation.y = 0.0f;
+			limit(separation, params.maxForce);
+		}
+	}
+}
+
+// Avoidance of one obstacle, folded into the running average of the obstacles so far.
+// The division after every obstacle in reach (not once at the end) is the original
+// behavior, so the result depends on the order of the obstacles.
+static void avoidObstacle(const Vec3& myPos, const Obstacle& obs, const BoidParams& params,
+	Vec3& obstacleAvoid, int& avoidCount)
+{
+	const GLfloat separationRadius = params.separationRadius;
+
+	if (!obs.canCollide()) return;
+	Vec3 obsPos = obs.getPosition();
+	Vec3 obsSize = obs.getSize();
+
+	// Obstacle AABB in XZ plane
+	GLfloat halfX = obsSize.x * 0.5f + separationRadius + safetyPadding;
+	GLfloat halfZ = obsSize.z * 0.5f + separationRadius + safetyPadding;
+
+	// AABB min and max
+	GLfloat minX = obsPos.x - halfX;
+	GLfloat maxX = obsPos.x + halfX;
+	GLfloat minZ = obsPos.z - halfZ;
+	GLfloat maxZ = obsPos.z + halfZ;
+
+	// AABB rejection test
+	if (myPos.x < minX && myPos.x < obsPos.x - (halfX + separationRadius)) return;
+	if (myPos.x > maxX && myPos.x > obsPos.x + (halfX + separationRadius)) return;
+	if (myPos.z < minZ && myPos.z < obsPos.z - (halfZ + separationRadius)) return;
+	if (myPos.z > maxZ && myPos.z > obsPos.z + (halfZ + separationRadius)) return;
+
+	// Closest point on AABB to boid (XZ)
+	GLfloat closestX = myPos.x;
+	if (closestX < minX) closestX = minX;
+	if (closestX > maxX) closestX = maxX;
+	GLfloat closestZ = myPos.z;
+	if (closestZ < minZ) closestZ = minZ;
+	if (closestZ > maxZ) closestZ = maxZ;
+
+	// Vector from obstacle surface (closest point) to boid in XZ
+	GLfloat dx = myPos.x - closestX;
+	GLfloat dz = myPos.z - closestZ;
+	GLfloat dist2 = dx * dx + dz * dz;
+
+	// Approximate circular threat radius (for smooth falloff)
+	GLfloat approxRadius = std::max(std::max(obsSize.x, obsSize.z) * 0.5f, 1.0f) + separationRadius + safetyPadding;
+	GLfloat approxRadius2 = approxRadius * approxRadius;
+
+	// If inside inflated AABB (dist2 == 0) or within approx radius, compute avoidance
+	if (dist2 == 0.0f || dist2 < approxRadius2)
+	{
+		Vec3 away;
+		GLfloat dist = 0.0f;
+		if (dist2 == 0.0f)
+		{
+			// Boid is inside the inflated AABB; push directly away from obstacle center in XZ
+			away = { myPos.x - obsPos.x, 0.0f, myPos.z - obsPos.z };
+			// fallback if exactly coincident
+			if (length2(away) < 1e-9f)
+				away = UnitX;
+
+			normalize(away);
+			dist = 0.0f;
+		}
+		else
+		{
+			away = { dx, 0.0f, dz };
+			dist = std::sqrt(dist2);
+			normalize(away);
+		}
+
+		// Strength: stronger if inside AABB or very close, smooth falloff otherwise
+		GLfloat normalized = 0.0f;
+		if (dist == 0.0f)
+			normalized = 1.0f; // maximum repulsion if inside box
+		else
+			normalized = (approxRadius - dist) / approxRadius; // 0..1
+
+		// non-linear scaling to make force ramp up quickly when near/inside
+		GLfloat strength = normalized * normalized;
+		if (dist < (std::max(obsSize.x, obsSize.z) * 0.25f + 0.001f))
+			strength = std::min(1.0f, strength * 3.0f);
+
+		// Compose avoidance vector (scale by obstacleWeight and boid's maxSpeed)
+		obstacleAvoid += away * (strength * obstacleWeight * params.maxSpeed);
+		++avoidCount;
+	}
+	// Average avoidance if multiple obstacles
+	if (avoidCount > 0)
+		obstacleAvoid /= static_cast<GLfloat>(avoidCount);
+}
+
+#if defined(__AVX2__)
+
+// Append to 'out' the obstacles of the packed boxes [begin, end) that pass the rejection
+// test of avoidObstacle, testing 8 boxes per iteration (AVX2)
+static void reachableBoxes(const PackedBoxes& boxes, size_t begin, size_t end, GLfloat x, GLfloat z,
+	GLfloat separationRadius, std::vector<uint32_t>& out)
+{
+	const __m256 px = _mm256_set1_ps(x), pz = _mm256_set1_ps(z);
+	const __m256 sep = _mm256_set1_ps(separationRadius);
+	const __m256 pad = _mm256_set1_ps(safetyPadding);
+
+	for (size_t i = begin; i < end; i += PackedBoxes::blockSize)
+	{
+		const __m256 cx = _mm256_loadu_ps(boxes.centerX.data() + i);
+		const __m256 cz = _mm256_loadu_ps(boxes.centerZ.data() + i);
+
+		// Inflated box plus one separation radius, rounded like avoidObstacle
+		const __m256 halfX = _mm256_add_ps(_mm256_add_ps(_mm256_loadu_ps(boxes.halfX.data() + i), sep), pad);
+		const __m256 halfZ = _mm256_add_ps(_mm256_add_ps(_mm256_loadu_ps(boxes.halfZ.data() + i), sep), pad);
+		const __m256 reachX = _mm256_add_ps(halfX, sep);
+		const __m256 reachZ = _mm256_add_ps(halfZ, sep);
+		__m256 hit = _mm256_and_ps(_mm256_cmp_ps(px, _mm256_sub_ps(cx, reachX), _CMP_GE_OQ),
+			_mm256_cmp_ps(px, _mm256_add_ps(cx, reachX), _CMP_LE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(pz, _mm256_sub_ps(cz, reachZ), _CMP_GE_OQ),
+			_mm256_cmp_ps(pz, _mm256_add_ps(cz, reachZ), _CMP_LE_OQ)));
+
+		for (unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(hit)); mask != 0; mask &= mask - 1)
+			out.push_back(boxes.obstacle[i + std::countr_zero(mask)]);
+	}
+}
+
+#else
+
+// Append to 'out' the obstacles of the packed boxes [begin, end) that pass the rejection
+// test of avoidObstacle
+static void reachableBoxes(const PackedBoxes& boxes, size_t begin, size_t end, GLfloat x, GLfloat z,
+	GLfloat separationRadius, std::vector<uint32_t>& out)
+{
+	for (size_t i = begin; i < end; ++i)
+	{
+		// Inflated box plus one separation radius, rounded like avoidObstacle
+		GLfloat reachX = (boxes.halfX[i] + separationRadius + safetyPadding) + separationRadius;
+		GLfloat reachZ = (boxes.halfZ[i] + separationRadius + safetyPadding) + separationRadius;
+		if (x < boxes.centerX[i] - reachX || x > boxes.centerX[i] + reachX) continue;
+		if (z < boxes.centerZ[i] - reachZ || z > boxes.centerZ[i] + reachZ) continue;
+		out.push_back(boxes.obstacle[i]);
+	}
+}
+
+#endif
+
+// Avoidance of the world obstacles (gWorldObstacles)
+Vec3 steerObstacles(const Vec3& myPos, const BoidParams& params)
+{
+	Vec3 obstacleAvoid(Zero);
+	if (!gWorldObstacles) return obstacleAvoid;
+
+	int avoidCount = 0;
+
+	// Without an up-to-date hierarchy, test every obstacle
+	if (!gWorldObstacleBVH || gWorldObstacleBVH->getSourceCount() != gWorldObstacles->size())
+	{
+		for (auto& obs : *gWorldObstacles)
+			avoidObstacle(myPos, obs, params, obstacleAvoid, avoidCount);
+		return obstacleAvoid;
+	}
+
+	// Packed boxes of the leaves within reach of the rejection test (1 unit of slack
+	// keeps rounding from dropping boxes at the edge), filtered 8 at a time. The boxes
+	// left go through avoidObstacle in vector order, as in a loop over every obstacle.
+	const GLfloat reach = 2.0f * params.separationRadius + safetyPadding + 1.0f;
+	const PackedBoxes& boxes = gWorldObstacleBVH->getPacked();
+	thread_local std::vector<uint32_t> nearby;
+	nearby.clear();
+	gWorldObstacleBVH->forEachLeaf(myPos.x - reach, myPos.z - reach, myPos.x + reach, myPos.z + reach,
+		[&](size_t begin, size_t end)
+		{
+			reachableBoxes(boxes, begin, end, myPos.x, myPos.z, params.separationRadius, nearby);
+		});
+	std::sort(nearby.begin(), nearby.end());
+	for (uint32_t i : nearby)
+		avoidObstacle(myPos, (*gWorldObstacles)[i], params, obstacleAvoid, avoidCount);
+	return obstacleAvoid;
+}
+
+// Avoidance of the obstacles and the tower from the baked distance field
+bool steerField(const Vec3& myPos, const BoidParams& params, Vec3& avoid)
+{
+	if (!gWorldDistanceField) return false;
+
+	GLfloat dist, gradX, gradZ;
+	if (!gWorldDistanceField->sample(myPos.x, myPos.z, dist, gradX, gradZ)) return false;
+
+	// Same reach as the box test: the inflated box plus one more separation radius
+	const GLfloat inflate = params.separationRadius + safetyPadding;
+	const GLfloat threat = inflate + params.separationRadius;
+	avoid = Zero;
+	if (dist >= threat) return true;
+
+	Vec3 away = { gradX, 0.0f, gradZ };
+	if (length2(away) < 1e-9f) return true;
+	normalize(away);
+
+	// Full strength inside a surface, quadratic falloff outside, boosted inside the inflated box
+	GLfloat normalized = dist <= 0.0f ? 1.0f : (threat - dist) / threat;
+	GLfloat strength = normalized * normalized;
+	if (dist < inflate)
+		strength = std::min(1.0f, strength * 3.0f);
+
+	avoid = away * (strength * obstacleWeight * params.maxSpeed);
+	return true;
+}
+
+// Avoidance of the world tower (gWorldTower)
+Vec3 steerTower(const Vec3& myPos, const BoidParams& params)
+{
+	Vec3 towerAvoid(Zero);
+	if (!gWorldTower || !gWorldTower->canCollide()) return towerAvoid;
+
+	Vec3 towerPos = gWorldTower->getPosition();
+
+	// Distance in XZ plane
+	GLfloat dx = myPos.x - towerPos.x;
+	GLfloat dz = myPos.z - towerPos.z;
+	GLfloat dist = std::sqrt(dx * dx + dz * dz);
+
+	// Radius of tower base
+	Vec3 towerSize = gWorldTower->getSize();
+	GLfloat radius = std::max(std::max(towerSize.x, towerSize.z) * 0.75f, 1.0f);
+
+	// Threat radius
+	GLfloat threatRadius = radius + params.separationRadius + safetyPadding;
+
+	if (dist > 0.0f && dist < threatRadius)
+	{
+		// Direction away from tower in XZ
+		Vec3 away = { dx, 0.0f, dz };
+		normalize(away);
+
+		// Strength based on distance
+		GLfloat normalized = (threatRadius - dist) / threatRadius; // 0..1
+		GLfloat strength = normalized * normalized; // non-linear scaling
+
+		// Boost strength if very close
+		const GLfloat closeBoost = 3.0f;
+		if (dist < radius * 0.5f)
+			strength = std::min(1.0f, strength * closeBoost);
+
+		const GLfloat towerWeight = obstacleWeight * 1.8f; // Stronger weight for tower
+		towerAvoid = away * (strength * towerWeight * params.maxSpeed);
+	}
+	return towerAvoid;
+}
+
+// Attraction towards the leader boid
+Vec3 steerLeader(const Vec3& myPos, const Vec3& vel, const ControlledBoid* leader, const BoidParams& params,
+	const FlowField* flow)
+{
+	Vec3 leaderAttract(Zero);
+	if (!leader) return leaderAttract;
+
+	// Vector to leader
+	Vec3 toLeader = leader->getPosition() - myPos;
+	GLfloat dist = length(toLeader);
+
+	// Only attract if beyond a small threshold
+	if (dist > 0.001f)
+	{
+		normalize(toLeader);
+
+		// Same climb rate, horizontal heading from the flow field
+		GLfloat flowX, flowZ;
+		if (flow && flow->sample(myPos.x, myPos.z, flowX, flowZ))
+		{
+			GLfloat horizontal = std::sqrt(toLeader.x * toLeader.x + toLeader.z * toLeader.z);
+			toLeader.x = flowX * horizontal;
+			toLeader.z = flowZ * horizontal;
+		}
+		Vec3 desired = toLeader * params.maxSpeed;
+		leaderAttract = desired - vel;
+		limit(leaderAttract, params.maxForce);
+	}
+	return leaderAttract;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+#include "FlockState.h"
+#include "SummedAreaTable.h"
+#include "FlowField.h"
+#include "vecFunctions.h"
+
+class ControlledBoid;
+
+/* Steering behaviors for boids stored in a FlockState */
+
+// Flocking behaviors of boid 'self' in a single pass over its neighbor candidates:
+// cohesion (average position), separation (inverse distance push) and alignment (average heading).
+// With useSimd the candidates are tested 8 at a time (AVX2) or 4 at a time (SSE2) when available.
+void steerNeighbors(const FlockState& state, uint32_t self,
+	const uint32_t* neighbors, size_t count, const BoidParams& params,
+	Vec3& cohesion, Vec3& separation, Vec3& alignment, bool useSimd = true);
+
+// Cohesion and alignment from the sums of 'count' neighbor positions and velocities (XZ)
+void steerAverages(const Vec3& pos, const Vec3& vel, GLfloat sumX, GLfloat sumZ,
+	GLfloat sumVelX, GLfloat sumVelZ, int count, const BoidParams& params, Vec3& cohesion, Vec3& alignment);
+
+// Approximate flocking from summed-area tables: cohesion and alignment use the mean of
+// the boids in the cells within neighRadius, separation pushes away from the mean
+// position of the cells within separationRadius. Cost does not depend on the density.
+void steerSummedArea(const SummedAreaTable& table, const Vec3& pos, const Vec3& vel,
+	const BoidParams& params, Vec3& cohesion, Vec3& separation, Vec3& alignment);
+
+// Avoidance of the world obstacles (gWorldObstacles)
+Vec3 steerObstacles(const Vec3& pos, const BoidParams& params);
+
+// Avoidance of the obstacles and the tower from one lookup in the baked distance field
+// (gWorldDistanceField); false, leaving 'avoid' untouched, where the field has no data
+bool steerField(const Vec3& pos, const BoidParams& params, Vec3& avoid);
+
+// Avoidance of the world tower (gWorldTower)
+Vec3 steerTower(const Vec3& pos, const BoidParams& params);
+
+// Attraction towards the leader boid; with a flow field toward the leader the
+// horizontal heading follows the field around the obstacles instead of the straight line
+Vec3 steerLeader(const Vec3& pos, const Vec3& vel, const ControlledBoid* leader, const BoidParams& params,
+	const FlowField* flow = nullptr);
@@ -0,0 +1,118 @@
+#include <cmath>
+#include <algorithm>
+
+#include "SummedAreaTable.h"
+
+// Lower bound on the cell budget, so small flocks keep a fine grid
+static const size_t minCellBudget = 1 << 16;
+
+// Rebuild the tables from n points
+void SummedAreaTable::build(const GLfloat* x, const GLfloat* z, const GLfloat* velX, const GLfloat* velZ,
+	size_t n, GLfloat size)
+{
+	table.clear();
+	width = height = 0;
+	if (n == 0) return;
+
+	auto [minX, maxX] = std::minmax_element(x, x + n);
+	auto [minZ, maxZ] = std::minmax_element(z, z + n);
+	const GLfloat extentX = *maxX - *minX;
+	const GLfloat extentZ = *maxZ - *minZ;
+
+	// About four cells per point at most
+	const double budget = static_cast<double>(std::max(4 * n, minCellBudget));
+	cellSize = std::max(size, 1e-3f);
+	cellSize = std::max(cellSize, static_cast<GLfloat>(std::sqrt(extentX * static_cast<double>(extentZ) / budget)));
+	invCellSize = 1.0f / cellSize;
+
+	originX = *minX;
+	originZ = *minZ;
+	width = static_cast<int32_t>(extentX * invCellSize) + 1;
+	height = static_cast<int32_t>(extentZ * invCellSize) + 1;
+
+	// Very elongated bounds: widen the cells until the budget holds
+	while (static_cast<double>(width) * height > 4.0 * budget)
+	{
+		cellSize *= 2.0f;
+		invCellSize = 1.0f / cellSize;
+		width = static_cast<int32_t>(extentX * invCellSize) + 1;
+		height = static_cast<int32_t>(extentZ * invCellSize) + 1;
+	}
+
+	// Per-cell sums, stored one row and one column in from the table's zero border
+	const size_t stride = static_cast<size_t>(width) + 1;
+	table.assign(stride * (static_cast<size_t>(height) + 1), Sums());
+	for (size_t i = 0; i < n; ++i)
+	{
+		int32_t cx = cellCoord(x[i], originX, width);
+		int32_t cz = cellCoord(z[i], originZ, height);
+		Sums& cell = table[(cz + 1) * stride + (cx + 1)];
+		cell.count += 1.0;
+		cell.sumX += x[i];
+		cell.sumZ += z[i];
+		cell.sumVelX += velX[i];
+		cell.sumVelZ += velZ[i];
+	}
+
+	// Prefix sums along the rows, then down the columns
+	for (int32_t j = 1; j <= height; ++j)
+	{
+		Sums* row = &table[j * stride];
+		for (int32_t i = 1; i <= width; ++i)
+		{
+			row[i].count += row[i - 1].count;
+			row[i].sumX += row[i - 1].sumX;
+			row[i].sumZ += row[i - 1].sumZ;
+			row[i].sumVelX += row[i - 1].sumVelX;
+			row[i].sumVelZ += row[i - 1].sumVelZ;
+		}
+	}
+	for (int32_t j = 2; j <= height; ++j)
+	{
+		Sums* row = &table[j * stride];
+		const Sums* above = &table[(j - 1) * stride];
+		for (int32_t i = 1; i <= width; ++i)
+		{
+			row[i].count += above[i].count;
+			row[i].sumX += above[i].sumX;
+			row[i].sumZ += above[i].sumZ;
+			row[i].sumVelX += above[i].sumVelX;
+			row[i].sumVelZ += above[i].sumVelZ;
+		}
+	}
+}
+
+// Sums over the cells overlapping the square of half side 'half' around (x, z)
+SummedAreaTable::Sums SummedAreaTable::query(GLfloat x, GLfloat z, GLfloat half) const
+{
+	Sums s;
+	if (table.empty()) return s;
+
+	// Cells [x0, x1] x [z0, z1], i.e. prefix entries x0 .. x1 + 1
+	const int32_t x0 = cellCoord(x - half, originX, width);
+	const int32_t x1 = cellCoord(x + half, originX, width) + 1;
+	const int32_t z0 = cellCoord(z - half, originZ, height);
+	const int32_t z1 = cellCoord(z + half, originZ, height) + 1;
+
+	const size_t stride = static_cast<size_t>(width) + 1;
+	const Sums& a = table[z1 * stride + x1];
+	const Sums& b = table[z0 * stride + x1];
+	const Sums& c = table[z1 * stride + x0];
+	const Sums& d = table[z0 * stride + x0];
+
+	s.count = a.count - b.count - c.count + d.count;
+	s.sumX = a.sumX - b.sumX - c.sumX + d.sumX;
+	s.sumZ = a.sumZ - b.sumZ - c.sumZ + d.sumZ;
+	s.sumVelX = a.sumVelX - b.sumVelX - c.sumVelX + d.sumVelX;
+	s.sumVelZ = a.sumVelZ - b.sumVelZ - c.sumVelZ + d.sumVelZ;
+	return s;
+}
+
+// Cell coordinate of v along an axis, clamped to [0, cells)
+int32_t SummedAreaTable::cellCoord(GLfloat v, GLfloat origin, int32_t cells) const
+{
+	GLfloat c = std::floor((v - origin) * invCellSize);
+	if (c < 0.0f) return 0;
+	if (c >= static_cast<GLfloat>(cells)) return cells - 1;
+	return static_cast<int32_t>(c);
+}
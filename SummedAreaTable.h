@@ -0,0 +1,47 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <GL/glut.h>
+
+// Summed-area tables of boid count, position and velocity over a uniform XZ grid.
+// After a build, the sums over any box of cells cost four lookups, however many
+// boids the box holds.
+class SummedAreaTable
+{
+public:
+	// Sums over a box of cells (double: the tables subtract large prefix sums)
+	struct Sums
+	{
+		double count = 0.0;
+		double sumX = 0.0, sumZ = 0.0;			// Sum of positions
+		double sumVelX = 0.0, sumVelZ = 0.0;	// Sum of velocities
+	};
+
+	SummedAreaTable() = default;
+	~SummedAreaTable() = default;
+
+	// Rebuild the tables from n points (x[i], z[i]) with velocities (velX[i], velZ[i]).
+	// The cell size grows if the points' bounds would need too many cells.
+	void build(const GLfloat* x, const GLfloat* z, const GLfloat* velX, const GLfloat* velZ,
+		size_t n, GLfloat cellSize);
+
+	// Sums over the cells overlapping the square of half side 'half' around (x, z)
+	Sums query(GLfloat x, GLfloat z, GLfloat half) const;
+
+	GLfloat getCellSize() const { return cellSize; }
+
+	// Bytes held by the tables
+	size_t getMemoryUsage() const { return table.capacity() * sizeof(Sums); }
+
+private:
+	// Cell coordinate of v along an axis starting at 'origin', clamped to [0, cells)
+	int32_t cellCoord(GLfloat v, GLfloat origin, int32_t cells) const;
+
+	GLfloat originX = 0.0f, originZ = 0.0f;	// Corner of the first cell
+	GLfloat cellSize = 1.0f;				// Size of a cell
+	GLfloat invCellSize = 1.0f;				// Inverse of the cell size
+	int32_t width = 0, height = 0;			// Cells along x and z
+
+	// Prefix sums: entry (i, j) sums the cells [0, i) x [0, j); (width + 1) per row
+	std::vector<Sums> table;
+};
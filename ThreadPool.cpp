@@ -0,0 +1,89 @@
+#include <algorithm>
+
+#include "ThreadPool.h"
+
+// threadCount includes the calling thread; 0 uses the hardware concurrency
+ThreadPool::ThreadPool(unsigned threadCount)
+{
+	if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	for (unsigned w = 1; w < threadCount; ++w)
+		workers.emplace_back(&ThreadPool::workerLoop, this, w);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wakeCondition.notify_all();
+	for (auto& t : workers)
+		t.join();
+}
+
+// Run func over [0, count) in chunks of 'grain' indices and wait for completion
+void ThreadPool::run(size_t count, size_t grain, RangeFunc func, void* ctx)
+{
+	if (count == 0) return;
+	grain = std::max<size_t>(grain, 1);
+
+	// Not worth waking the workers for a single chunk
+	if (workers.empty() || count <= grain)
+	{
+		func(ctx, 0, count, 0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobFunc = func;
+		jobContext = ctx;
+		jobCount = count;
+		jobGrain = grain;
+		nextIndex.store(0);
+		busyWorkers = static_cast<unsigned>(workers.size());
+		++generation;
+	}
+	wakeCondition.notify_all();
+
+	// The calling thread works too
+	runChunks(0);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	doneCondition.wait(lock, [this] { return busyWorkers == 0; });
+	jobFunc = nullptr;
+	jobContext = nullptr;
+}
+
+void ThreadPool::workerLoop(unsigned worker)
+{
+	uint64_t seen = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wakeCondition.wait(lock, [&] { return stopping || generation != seen; });
+			if (stopping) return;
+			seen = generation;
+		}
+
+		runChunks(worker);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--busyWorkers == 0)
+			doneCondition.notify_one();
+	}
+}
+
+// Take chunks of the current loop until none are left
+void ThreadPool::runChunks(unsigned worker)
+{
+	for (;;)
+	{
+		size_t begin = nextIndex.fetch_add(jobGrain);
+		if (begin >= jobCount) return;
+		size_t end = std::min(begin + jobGrain, jobCount);
+		jobFunc(jobContext, begin, end, worker);
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+// Fixed pool of worker threads running parallel-for loops
+class ThreadPool
+{
+public:
+	// threadCount includes the calling thread; 0 uses the hardware concurrency
+	explicit ThreadPool(unsigned threadCount = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Number of threads taking part in a loop, including the calling thread
+	unsigned getThreadCount() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+	// Run body(begin, end, worker) over [0, count) in chunks of 'grain' indices and wait
+	// for completion; worker 0 is the calling thread. The body is called by reference,
+	// so a loop does not allocate.
+	// Chunks are handed out dynamically, so which worker runs an index varies from run
+	// to run: for deterministic results the body must only write data owned by its indices.
+	template <typename Body>
+	void parallelFor(size_t count, size_t grain, Body&& body)
+	{
+		using BodyType = std::remove_reference_t<Body>;
+		run(count, grain, [](void* ctx, size_t begin, size_t end, unsigned worker)
+		{
+			(*static_cast<BodyType*>(ctx))(begin, end, worker);
+		}, const_cast<void*>(static_cast<const void*>(&body)));
+	}
+
+private:
+	// Type-erased loop body
+	using RangeFunc = void (*)(void* ctx, size_t begin, size_t end, unsigned worker);
+
+	void run(size_t count, size_t grain, RangeFunc func, void* ctx);
+	void workerLoop(unsigned worker);
+	void runChunks(unsigned worker);
+
+	std::vector<std::thread> workers;	// Worker threads (the caller is worker 0)
+	std::mutex mutex;
+	std::condition_variable wakeCondition;	// Signals a new loop or shutdown
+	std::condition_variable doneCondition;	// Signals that all workers finished the loop
+
+	// Current loop
+	RangeFunc jobFunc = nullptr;
+	void* jobContext = nullptr;
+	size_t jobCount = 0;
+	size_t jobGrain = 1;
+	std::atomic<size_t> nextIndex{ 0 };
+	uint64_t generation = 0;	// Incremented for every loop
+	unsigned busyWorkers = 0;	// Workers still running the current loop
+	bool stopping = false;
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Lock-free triple buffer handing values from one writer thread to one reader thread.
+// The writer fills the back slot and publishes it; the reader picks up the newest
+// published slot. Neither side ever waits for the other.
+template <typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() = default;
+
+	// Slot owned by the writer
+	T& getWriteBuffer() { return slots[backIndex]; }
+
+	// Writer: make the write buffer the newest value and take the spare slot
+	void publish()
+	{
+		uint8_t previous = middle.exchange(static_cast<uint8_t>(backIndex | freshBit), std::memory_order_acq_rel);
+		backIndex = previous & indexMask;
+	}
+
+	// Reader: switch to the newest published value, if any. Returns true if it changed.
+	bool update()
+	{
+		if (!(middle.load(std::memory_order_relaxed) & freshBit)) return false;
+		uint8_t previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+		frontIndex = previous & indexMask;
+		return true;
+	}
+
+	// Slot owned by the reader
+	T& getReadBuffer() { return slots[frontIndex]; }
+
+private:
+	static constexpr uint8_t indexMask = 0x3;
+	static constexpr uint8_t freshBit = 0x4;	// Set when the middle slot has not been read yet
+
+	T slots[3];
+	std::atomic<uint8_t> middle{ 1 };	// Shared slot (index | freshBit)
+	uint8_t backIndex = 0;				// Writer's slot
+	uint8_t frontIndex = 2;				// Reader's slot
+};
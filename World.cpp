@@ -4,4 +4,6 @@
 
 // Definies dos ponteiros globais declarados em World.h
 std::vector<Obstacle>* gWorldObstacles = nullptr;
+const ObstacleBVH* gWorldObstacleBVH = nullptr;
+const DistanceField* gWorldDistanceField = nullptr;
 Tower* gWorldTower = nullptr;
@@ -3,6 +3,10 @@
 
 class Obstacle;
 class Tower;
+class ObstacleBVH;
+class DistanceField;
 
 extern std::vector<Obstacle>* gWorldObstacles;
+extern const ObstacleBVH* gWorldObstacleBVH;	// Hierarchy over gWorldObstacles (may be null)
+extern const DistanceField* gWorldDistanceField;	// Distance to the obstacles and tower (may be null)
 extern Tower* gWorldTower;
@@ -5,6 +5,7 @@
 #include <vector>
 #include <string>
 #include <cmath>
+#include <mutex>
 
 #include "Tower.h"
 #include "Floor.h"
@@ -16,6 +17,7 @@
 #include "vecFunctions.h"
 #include "HUD.h"
 #include "ObstacleManager.h"
+#include "Simulation.h"
 
 /* GLUT callback Handlers variables */
 
@@ -45,6 +47,9 @@ static ObstacleManager* sObstacleManager = nullptr;
 
 // Time tracking
 static GLfloat sLastTime = 0.0f;
+
+// Simulation running on its own thread
+static Simulation* sSimulation = nullptr;
 static bool sFullscreen = true;
 static bool sPaused = false;
 static std::vector<std::string> sHUDLines = prepareHUDLines();
@@ -80,10 +85,19 @@ void enableFog()
 
 inline void disableFog() { glDisable(GL_FOG); }
 
+// Lock the simulated objects against the simulation thread before changing them
+static std::unique_lock<std::mutex> lockSimulation()
+{
+	if (!sSimulation) return std::unique_lock<std::mutex>();
+	return std::unique_lock<std::mutex>(sSimulation->getMutex());
+}
+
 // Display callback: render the scene
 static void display(void)
 {
-	// Calculate delta time
+	if (!sSimulation) return;
+
+	// Calculate delta time (camera smoothing)
 	const GLfloat time = glutGet(GLUT_ELAPSED_TIME) / 1000.0f;
 	GLfloat dt;
 	if (sLastTime <= 0.0f)
@@ -99,14 +113,15 @@ static void display(void)
 	// Enable or disable fog
 	sFogEnabled ? enableFog() : disableFog();
 
-	// Update boids if not paused
-	if (!sPaused && sControlledBoid) sControlledBoid->update(dt);
-	if (!sPaused && sFlock) sFlock->update(dt);
+	// Newest completed simulation step; never waits for the simulation thread
+	SimSnapshot& snapshot = sSimulation->acquireSnapshot();
+	ControlledBoid& leader = snapshot.leader;
+	const GLfloat alpha = sSimulation->getInterpolationAlpha(snapshot);
 
-	// Get positions and sizes
+	// Get positions and sizes (leader interpolated like its drawing)
 	Vec3 cbPos, towerPos, towerSize;
 	if (sControlledBoid)
-		cbPos = sControlledBoid->getPosition();
+		cbPos = leader.getInterpolatedPosition(alpha);
 
 	if (sTower)
 	{
@@ -114,7 +129,7 @@ static void display(void)
 		towerSize = sTower->getSize();
 	}
 
-	Vec3 flockCenter = sFlock ? sFlock->getAvgPosition() : cbPos;
+	Vec3 flockCenter = sFlock ? snapshot.flockCenter : cbPos;
 	Vec3 desiredPos, desiredTarget, currPos, currTarget, smoothPos, smoothTarget;
 	Vec3 offset, forwardDir, rightCamPos, right;
 	GLfloat yawRad = 0.0f, height, t;
@@ -126,7 +141,7 @@ static void display(void)
 		if (sFollowCamera && sControlledBoid)
 		{
 			// Desired camera position and target
-			yawRad = sControlledBoid->getYaw() * (PI / 180.0f);
+			yawRad = leader.getYaw() * (PI / 180.0f);
 			offset = {
 				-sin(yawRad) * sCameraDistance,
 				sCameraDistance * 0.2f,
@@ -170,7 +185,7 @@ static void display(void)
 		if (sControlledBoid && sSideCamera)
 		{
 			// Side Camera position and target
-			yawRad = sControlledBoid->getYaw() * (PI / 180.0f);
+			yawRad = leader.getYaw() * (PI / 180.0f);
 			forwardDir = { std::sin(yawRad), 0.0f, std::cos(yawRad) };
 			right = crossProduct(forwardDir, UnitY);
 			normalize(right);
@@ -200,11 +215,16 @@ static void display(void)
 	default: break;
 	}
 
+	// The flock steers the boids near the camera every step
+	Camera* activeCamera = sCurrentCamera == FOLLOW_CAMERA ? sFollowCamera
+		: sCurrentCamera == FIXED_CAMERA ? sFixedCamera : sSideCamera;
+	if (activeCamera) sSimulation->setCameraPosition(activeCamera->getPosition());
+
 	// Draw scene objects
 	if (sFloor) sFloor->draw();
 	if (sTower) sTower->draw();
-	if (sControlledBoid) sControlledBoid->draw();
-	if (sFlock) sFlock->draw();
+	if (sControlledBoid) leader.draw(alpha);
+	if (sFlock) sFlock->draw(snapshot.previousFlock, snapshot.flock, alpha);
 	if (sWalls)
 		for (auto& w : *sWalls)
 			w.draw();
@@ -213,7 +233,7 @@ static void display(void)
 	disableFog();
 
 	// Draw HUD overlay
-	int boidCount = sFlock ? sFlock->getBoidCount() : 0;
+	int boidCount = sFlock ? static_cast<int>(snapshot.flock.size()) : 0;
 	int obstacleCount = sObstacleManager ? sObstacleManager->size() : 0;
 	drawHUD(boidCount, obstacleCount, sHUDLines);
 
@@ -256,6 +276,7 @@ static void keyboardControl(unsigned char key, int x, int y)
 	const GLfloat minHeight = 2.0f;		// minimum height
 	const GLfloat maxHeight = 50.0f;	// maximum height
 	if (!sControlledBoid) return;		// No controlled boid available
+	auto lock = lockSimulation();
 
 	switch (key)
 	{
@@ -287,6 +308,7 @@ static void keyboardControl(unsigned char key, int x, int y)
 
 	case ' ': // Pause/unpause simulation
 		sPaused = !sPaused;
+		if (sSimulation) sSimulation->setPaused(sPaused);
 		break;
 
 	case 'z': case 'Z': // Stop movement
@@ -326,6 +348,13 @@ static void keyboardControl(unsigned char key, int x, int y)
 	case '2': sCurrentCamera = FIXED_CAMERA; break;
 	case '3': sCurrentCamera = SIDE_CAMERA; break;
 
+		// Toggle metric/topological neighbors
+	case 'k': case 'K':
+		if (sFlock)
+			sFlock->setNeighborMode(sFlock->getNeighborMode() == NeighborMode::Metric ?
+				NeighborMode::Topological : NeighborMode::Metric);
+		break;
+
 		// Increase/decrease boid count
 	case '+': case '=':
 		if (sFlock) sFlock->addBoid();
@@ -336,7 +365,12 @@ static void keyboardControl(unsigned char key, int x, int y)
 		break;
 
 		// Exit
-	case 27: exit(0); break;
+	case 27:
+		// Stop the simulation thread before exiting
+		lock.unlock();
+		if (sSimulation) sSimulation->stop();
+		exit(0);
+		break;
 
 	default: break;
 	}
@@ -348,6 +382,7 @@ static void cameraSpecial(int key, int x, int y)
 {
 	const GLfloat rotateAmount = 5.0f; // degrees per key press
 	if (!sControlledBoid) return;
+	auto lock = lockSimulation();
 
 	switch (key)
 	{
@@ -405,11 +440,18 @@ void registerWorldObjects(
 	sTower = &tower;
 }
 
+static void registerSimulation(Simulation& simulation)
+{
+	sSimulation = &simulation;
+}
+
 static void registerObstacleManager(ObstacleManager& mgr)
 {
 	sObstacleManager = &mgr;
 	sWalls = &mgr.getObstacles();
 	gWorldObstacles = sWalls;
+	gWorldObstacleBVH = &mgr.getBVH();
+	gWorldDistanceField = &mgr.getDistanceField();
 }
 
 /* End of GLUT callback Handlers */
\ No newline at end of file
@@ -11,6 +11,8 @@
 #include "ObstacleManager.h"
 #include "vecFunctions.h"
 #include "World.h"
+#include "Headless.h"
+#include "Simulation.h"
 
 // Lighting parameters
 const GLfloat light_ambient[4] = { 0.1f, 0.1f, 0.1f, 1.0f };	 // Ambient light
@@ -26,6 +28,11 @@ const GLfloat high_shininess[1] = { 30.0f };
 
 int main(int argc, char* argv[])
 {
+	// Headless benchmark or determinism check: run the flock without a window
+	HeadlessOptions headless;
+	if (parseHeadlessOptions(argc, argv, headless))
+		return headless.check ? runDeterminismCheck(headless) : runHeadless(headless);
+
 	// Initialize GLUT
 	glutInit(&argc, argv);
 	glutInitWindowPosition(0, 0);
@@ -42,6 +49,7 @@ int main(int argc, char* argv[])
 	ControlledBoid controlledBoid;
 	controlledBoid.setPosition(20.0f, 10.0f, 20.0f);
 	controlledBoid.setSize(0.5f, 0.1f, 0.5f);
+	controlledBoid.resetInterpolation();
 
 	// Create floor
 	Floor floor;
@@ -61,11 +69,16 @@ int main(int argc, char* argv[])
 	std::vector<Obstacle> walls;
 	ObstacleManager obstacleManager;
 	obstacleManager.setFloor(&floor);
+	obstacleManager.setTower(&tower);
 	obstacleManager.generateRandom(100);
 
 	// Create and initialize flock
 	Flock flock;
 	flock.init(50, &controlledBoid, floorSize.x * 0.2f);
+	flock.setNeighborSkin(3.0f);
+	flock.setLeaderFlowField(true);
+	flock.setLevelOfDetail(true);
+	flock.setSweptCollisions(true);
 
 	// Initialize cameras
 	Camera followCamera, fixedCamera, sideCamera;
@@ -76,6 +89,12 @@ int main(int argc, char* argv[])
 		flock, controlledBoid,
 		floor, tower);
 	registerObstacleManager(obstacleManager);
+
+	// Run the simulation on its own thread at a fixed rate
+	Simulation simulation;
+	simulation.setWorld(&controlledBoid, &flock);
+	simulation.setRate(60.0f, 5);
+	registerSimulation(simulation);
 	glutReshapeFunc(reshape);
 	glutDisplayFunc(display);
 	glutIdleFunc(idle);
@@ -109,7 +128,8 @@ int main(int argc, char* argv[])
 	glMaterialfv(GL_FRONT, GL_SPECULAR, mat_specular);
 	glMaterialfv(GL_FRONT, GL_SHININESS, high_shininess);
 
-	// Start GLUT main loop
+	// Start the simulation and the GLUT main loop
+	simulation.start();
 	glutMainLoop();
 	return 0;
 }